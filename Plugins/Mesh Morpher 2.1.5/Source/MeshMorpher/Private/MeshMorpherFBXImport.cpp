@@ -1,7 +1,10 @@
 ﻿// Copyright 2020-2022 SC Pug Life Studio S.R.L. All Rights Reserved.
 #include "MeshMorpherFBXImport.h"
+#include "MeshMorpherToolHelper.h"
 #include "DynamicMesh/MeshNormals.h"
 #include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Async/ParallelFor.h"
 
 // Get the geometry deformation local to a node. It is never inherited by the
 // children.
@@ -88,7 +91,7 @@ bool IsOddNegativeScale(const FbxAMatrix& TotalMatrix)
 	return NegativeNum == 1 || NegativeNum == 3;
 }
 
-FMeshMorpherFBXImport::FMeshMorpherFBXImport(const FString FileName, EMeshMorpherFBXCoordinate Coordinate, EMeshMorpherFBXAxis FrontVector, EMeshMorpherFBXAxis UpVector, const bool bConvertScene, const bool UseT0, const int32 ImportID)
+FMeshMorpherFBXImport::FMeshMorpherFBXImport(const FString FileName, EMeshMorpherFBXCoordinate Coordinate, EMeshMorpherFBXAxis FrontVector, EMeshMorpherFBXAxis UpVector, const bool bConvertScene, const bool UseT0, const int32 ImportID, const bool bBuildDynamicMesh)
 {
 	DynamicMesh.Clear();
 	DynamicMesh.EnableAttributes();
@@ -122,17 +125,170 @@ FMeshMorpherFBXImport::FMeshMorpherFBXImport(const FString FileName, EMeshMorphe
 			const bool bIsCollisionMesh = NodeName.StartsWith("UCX_");
 			if(!bIsCollisionMesh)
 			{
-				CreateSingleFBXMesh(i);
+				//nodes without a mesh or without any triangle or quad are not kept
+				FMeshMorpherFBXRawMesh RawMesh;
+				ExtractSingleFBXMesh(i, RawMesh);
+				if (RawMesh.PolygonSizes.Num() > 0)
+				{
+					RawMeshes.Add(MoveTemp(RawMesh));
+				}
 			}
 		}
 	}
 
-	if (FDynamicMeshNormalOverlay* NormalOverlay = DynamicMesh.Attributes()->PrimaryNormals())
+	if (bBuildDynamicMesh)
+	{
+		BuildDynamicMesh(RawMeshes, DynamicMesh);
+		RawMeshes.Empty();
+	}
+}
+
+void FMeshMorpherFBXImport::BuildDynamicMesh(const TArray<FMeshMorpherFBXRawMesh>& InRawMeshes, FDynamicMesh3& OutMesh)
+{
+	OutMesh.Clear();
+	OutMesh.EnableAttributes();
+	OutMesh.EnableTriangleGroups(0);
+
+	for (const FMeshMorpherFBXRawMesh& RawMesh : InRawMeshes)
+	{
+		//Every control point is appended in index order, so vertex IDs match the file even for unused control points
+		const int32 VertexOffset = OutMesh.MaxVertexID();
+		for (const FVector& Position : RawMesh.Positions)
+		{
+			OutMesh.AppendVertex(Position);
+		}
+		auto GetVertex = [VertexOffset](const int32 ControlPointIndex)->int32
+		{
+			return VertexOffset + ControlPointIndex;
+		};
+
+		int32 CornerOffset = 0;
+		for (const uint8 PolygonSize : RawMesh.PolygonSizes)
+		{
+			const int32* Corners = RawMesh.PolygonCorners.GetData() + CornerOffset;
+			CornerOffset += PolygonSize;
+
+			bool bValidPolygon = true;
+			for (int32 CornerIndex = 0; CornerIndex < PolygonSize; CornerIndex++)
+			{
+				bValidPolygon &= RawMesh.Positions.IsValidIndex(Corners[CornerIndex]);
+			}
+			if (!bValidPolygon)
+			{
+				continue;
+			}
+
+			if (PolygonSize == 3)
+			{
+				FIndex3i Triangle;
+				for (int32 CornerIndex = 0; CornerIndex < 3; CornerIndex++)
+				{
+					Triangle[CornerIndex] = GetVertex(Corners[CornerIndex]);
+				}
+				OutMesh.AppendTriangle(Triangle, RawMesh.GroupID);
+			}
+			else if (PolygonSize == 4)
+			{
+				FIntVector4 Polygon;
+				for (int32 CornerIndex = 0; CornerIndex < 4; CornerIndex++)
+				{
+					Polygon[CornerIndex] = GetVertex(Corners[CornerIndex]);
+				}
+				OutMesh.AppendTriangle(FIndex3i(Polygon[0], Polygon[1], Polygon[2]), RawMesh.GroupID);
+				OutMesh.AppendTriangle(FIndex3i(Polygon[0], Polygon[2], Polygon[3]), RawMesh.GroupID);
+			}
+		}
+	}
+
+	if (FDynamicMeshNormalOverlay* NormalOverlay = OutMesh.Attributes()->PrimaryNormals())
 	{
 		FMeshNormals::InitializeOverlayToPerVertexNormals(NormalOverlay);
 	}
 }
 
+bool FMeshMorpherFBXImport::ImportFile(const FString& FileName, EMeshMorpherFBXCoordinate Coordinate, EMeshMorpherFBXAxis FrontVector, EMeshMorpherFBXAxis UpVector, const bool bConvertScene, const bool UseT0, FMeshMorpherFBXImportResult& OutResult)
+{
+	TArray<FMeshMorpherFBXImportResult> Results;
+	ImportFiles({ FileName }, Coordinate, FrontVector, UpVector, bConvertScene, UseT0, Results);
+	OutResult = MoveTemp(Results[0]);
+	return OutResult.bSuccess;
+}
+
+void FMeshMorpherFBXImport::ImportFiles(const TArray<FString>& FileNames, EMeshMorpherFBXCoordinate Coordinate, EMeshMorpherFBXAxis FrontVector, EMeshMorpherFBXAxis UpVector, const bool bConvertScene, const bool UseT0, TArray<FMeshMorpherFBXImportResult>& OutResults)
+{
+	OutResults.Reset();
+	OutResults.SetNum(FileNames.Num());
+
+	TArray<TArray<FMeshMorpherFBXRawMesh>> FileRawMeshes;
+	FileRawMeshes.SetNum(FileNames.Num());
+
+	//OBJ files go through our own reader so vertex IDs follow the "v" lines, the axis settings only apply to FBX
+	TBitArray<> IsOBJFile(false, FileNames.Num());
+
+	//The FBX SDK is not thread safe, scenes are parsed one at a time and only plain geometry is kept
+	for (int32 FileIndex = 0; FileIndex < FileNames.Num(); ++FileIndex)
+	{
+		FMeshMorpherFBXImportResult& Result = OutResults[FileIndex];
+		Result.FileName = FileNames[FileIndex];
+		if (FPaths::GetExtension(Result.FileName).Equals(TEXT("obj"), ESearchCase::IgnoreCase))
+		{
+			IsOBJFile[FileIndex] = true;
+			continue;
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+		{
+			FMeshMorpherFBXImport Import(FileNames[FileIndex], Coordinate, FrontVector, UpVector, bConvertScene, UseT0, FileIndex, false);
+			Result.NumMeshNodes = Import.RawMeshes.Num();
+			Result.NumSkippedPolygons = Import.NumSkippedPolygons;
+			if (!Import.bSceneImported)
+			{
+				Result.Error = TEXT("Could not open or parse the file.");
+			}
+			else if (Import.RawMeshes.Num() == 0)
+			{
+				Result.Error = TEXT("No mesh found in the scene.");
+			}
+			FileRawMeshes[FileIndex] = MoveTemp(Import.RawMeshes);
+		}
+		Result.ParseSeconds = FPlatformTime::Seconds() - StartTime;
+	}
+
+	ParallelFor(FileNames.Num(), [&](const int32 FileIndex)
+	{
+		FMeshMorpherFBXImportResult& Result = OutResults[FileIndex];
+		const double StartTime = FPlatformTime::Seconds();
+		if (IsOBJFile[FileIndex])
+		{
+			Result.bSuccess = UMeshMorpherToolHelper::ImportOBJFileToDynamicMesh(Result.FileName, Result.DynamicMesh);
+			Result.NumMeshNodes = Result.bSuccess ? 1 : 0;
+			if (!Result.bSuccess)
+			{
+				Result.Error = TEXT("Could not read the file or no valid triangles.");
+			}
+		}
+		else if (FileRawMeshes[FileIndex].Num() > 0)
+		{
+			BuildDynamicMesh(FileRawMeshes[FileIndex], Result.DynamicMesh);
+			Result.bSuccess = Result.DynamicMesh.TriangleCount() > 0;
+			if (!Result.bSuccess)
+			{
+				Result.Error = TEXT("No valid triangles.");
+			}
+		}
+		FileRawMeshes[FileIndex].Empty();
+		Result.ConvertSeconds = FPlatformTime::Seconds() - StartTime;
+	});
+
+	for (const FMeshMorpherFBXImportResult& Result : OutResults)
+	{
+		if (!Result.bSuccess)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Failed to import %s: %s"), *Result.FileName, *Result.Error);
+		}
+	}
+}
+
 FMeshMorpherFBXImport::~FMeshMorpherFBXImport()
 {
 	if (Scene)
@@ -463,7 +619,7 @@ void FMeshMorpherFBXImport::InitializeFBXMesh(const FString& FileName, const int
 	
 	if (Importer->Initialize(Filename, - 1, ios))
 	{
-		Importer->Import(Scene);
+		bSceneImported = Importer->Import(Scene);
 
 		Importer->Destroy();
 		ios->Destroy();
@@ -725,8 +881,9 @@ void FMeshMorpherFBXImport::GetVertexArray(FbxMesh* FbxMesh, TArray<FbxVector4>&
 }
 
 
-void FMeshMorpherFBXImport::CreateSingleFBXMesh(const int32 i)
+void FMeshMorpherFBXImport::ExtractSingleFBXMesh(const int32 i, FMeshMorpherFBXRawMesh& OutRawMesh)
 {
+	OutRawMesh.GroupID = i;
 	if(outMeshArray.IsValidIndex((i)))
 	{
 		if (FbxNode* Node = outMeshArray[i])
@@ -751,64 +908,35 @@ void FMeshMorpherFBXImport::CreateSingleFBXMesh(const int32 i)
 
 				
 				TArray<FbxVector4> VertexArray;
-				GetVertexArray(Mesh, VertexArray);				
+				GetVertexArray(Mesh, VertexArray);
+
+				OutRawMesh.Positions.SetNumUninitialized(VertexArray.Num());
+				for (int32 ControlPointIndex = 0; ControlPointIndex < VertexArray.Num(); ControlPointIndex++)
+				{
+					const FbxVector4 FinalPosition = TotalMatrix.MultT(VertexArray[ControlPointIndex]);
+					OutRawMesh.Positions[ControlPointIndex] = ConvertPos(FinalPosition);
+				}
 
-				TMap<int32, int32> IndexMap;
 				const int32 TriangleCount = Mesh->GetPolygonCount();
+				OutRawMesh.PolygonSizes.Reserve(TriangleCount);
+				OutRawMesh.PolygonCorners.Reserve(TriangleCount * 3);
 				for (int32 TriangleIndex = 0; TriangleIndex < TriangleCount; TriangleIndex++)
 				{
 					const int32 polyVertCount = Mesh->GetPolygonSize(TriangleIndex);
-					if(polyVertCount == 3)
+					if(polyVertCount == 3 || polyVertCount == 4)
 					{
-						FIndex3i Triangle;
+						OutRawMesh.PolygonSizes.Add(static_cast<uint8>(polyVertCount));
 						for (int32 CornerIndex = 0; CornerIndex < polyVertCount; CornerIndex++)
 						{
-							const int32 ControlPointIndex = Mesh->GetPolygonVertex(TriangleIndex, CornerIndex);
-
-							if (const int32* ExistingIndex = IndexMap.Find(ControlPointIndex))
-							{
-								Triangle[CornerIndex] = *ExistingIndex;
-							}
-							else
-							{
-								FbxVector4 FbxPosition = VertexArray[ControlPointIndex];
-								const FbxVector4 FinalPosition = TotalMatrix.MultT(FbxPosition);
-
-								FVector VFinalPosition = ConvertPos(FinalPosition);
-								Triangle[CornerIndex] = DynamicMesh.AppendVertex(VFinalPosition);
-								IndexMap.Add(ControlPointIndex, Triangle[CornerIndex]);
-							}
+							OutRawMesh.PolygonCorners.Add(Mesh->GetPolygonVertex(TriangleIndex, CornerIndex));
 						}
-						DynamicMesh.AppendTriangle(Triangle, i);
 					}
-					else if(polyVertCount == 4)
+					else
 					{
-						FIntVector4 Polygon;
-						for (int32 CornerIndex = 0; CornerIndex < polyVertCount; CornerIndex++)
-						{
-							const int32 ControlPointIndex = Mesh->GetPolygonVertex(TriangleIndex, CornerIndex);
-
-							if (const int32* ExistingIndex = IndexMap.Find(ControlPointIndex))
-							{
-								Polygon[CornerIndex] = *ExistingIndex;
-							}
-							else
-							{
-								FbxVector4 FbxPosition = VertexArray[ControlPointIndex];
-								const FbxVector4 FinalPosition = TotalMatrix.MultT(FbxPosition);
-
-								FVector VFinalPosition = ConvertPos(FinalPosition);
-								Polygon[CornerIndex] = DynamicMesh.AppendVertex(VFinalPosition);
-								IndexMap.Add(ControlPointIndex, Polygon[CornerIndex]);
-							}
-						}
-						FIndex3i Triangle1 = FIndex3i(Polygon[0], Polygon[1], Polygon[2]);
-						FIndex3i Triangle2 = FIndex3i(Polygon[0], Polygon[2], Polygon[3]);
-						DynamicMesh.AppendTriangle(Triangle1, i);
-						DynamicMesh.AppendTriangle(Triangle2, i);
+						NumSkippedPolygons++;
 					}
 				}
 			}
 		}
 	}
-}
\ No newline at end of file
+}
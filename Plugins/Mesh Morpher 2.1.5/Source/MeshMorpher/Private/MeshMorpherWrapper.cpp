@@ -3,6 +3,7 @@
 #include "DynamicMesh/MeshNormals.h"
 #include "MeshOperationsLibraryRT.h"
 #include "DynamicMesh/DynamicMeshAABBTree3.h"
+#include "Spatial/PointHashGrid3.h"
 
 bool FMeshMorpherWrapper::IsDynamicMeshIdentical(const FDynamicMesh3& DynamicMeshA, const FDynamicMesh3& DynamicMeshB)
 {
@@ -33,6 +34,35 @@ bool FMeshMorpherWrapper::IsDynamicMeshIdentical(const FDynamicMesh3& DynamicMes
 	return false;
 }
 
+bool FMeshMorpherWrapper::IsDynamicMeshTopologyIdentical(const FDynamicMesh3& DynamicMeshA, const FDynamicMesh3& DynamicMeshB)
+{
+	if (DynamicMeshA.VertexCount() != DynamicMeshB.VertexCount() || DynamicMeshA.TriangleCount() != DynamicMeshB.TriangleCount())
+	{
+		return false;
+	}
+
+	if (DynamicMeshA.MaxVertexID() != DynamicMeshB.MaxVertexID() || DynamicMeshA.MaxTriangleID() != DynamicMeshB.MaxTriangleID())
+	{
+		return false;
+	}
+
+	//direct comparison, reads the index buffers once and stops at the first difference
+	for (int32 TriangleID = 0; TriangleID < DynamicMeshA.MaxTriangleID(); ++TriangleID)
+	{
+		const bool bIsTriangleA = DynamicMeshA.IsTriangle(TriangleID);
+		if (bIsTriangleA != DynamicMeshB.IsTriangle(TriangleID))
+		{
+			return false;
+		}
+
+		if (bIsTriangleA && DynamicMeshA.GetTriangle(TriangleID) != DynamicMeshB.GetTriangle(TriangleID))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
 bool FMeshMorpherWrapper::ProjectDeltas(const TArray<FMorphTargetDelta>& InDeltas, const bool bCheckMeshesIdentical, const double Multiplier, const int32 SmoothIterations, const double SmoothStrength, TArray<FMorphTargetDelta>& OutDeltas) const
 {
 	OutDeltas.Empty();
@@ -209,7 +239,7 @@ void FMeshMorpherWrapper::ComputeDeltaProjection(const FDynamicMesh3& SourceDyna
 
 }
 
-void FMeshMorpherWrapper::GetSmoothDeltas(const FDynamicMesh3& TargetDynamicMesh, TArray<FMorphTargetDelta>& Deltas, const double& SmoothStrength, TArray<FMorphTargetDelta>& OutSmoothDeltas) const
+void FMeshMorpherWrapper::GetSmoothDeltas(const FDynamicMesh3& TargetDynamicMesh, TArray<FMorphTargetDelta>& Deltas, const double& SmoothStrength, TArray<FMorphTargetDelta>& OutSmoothDeltas)
 {
 	const int32 TargetverticesNum = TargetDynamicMesh.VertexCount();
 
@@ -356,6 +386,20 @@ void FMeshMorpherWrapper::CreateDeltasForVertexPairs(const TArray<FMeshMorpherWr
 	const int32 Count = VertexPairs.Num();
 	if(Count > 0)
 	{
+		//Sum the base deltas per source vertex once, so every pair is a single lookup instead of a scan of all deltas
+		uint32 MaxSourceIdx = 0;
+		for(const FMorphTargetDelta& Delta : BaseDeltas)
+		{
+			MaxSourceIdx = FMath::Max(MaxSourceIdx, Delta.SourceIdx);
+		}
+
+		TArray<FVector3f> BaseDeltaSums;
+		BaseDeltaSums.SetNumZeroed(BaseDeltas.Num() > 0 ? static_cast<int32>(MaxSourceIdx) + 1 : 0);
+		for(const FMorphTargetDelta& Delta : BaseDeltas)
+		{
+			BaseDeltaSums[static_cast<int32>(Delta.SourceIdx)] += Delta.PositionDelta;
+		}
+
 		FCriticalSection Lock;
 		const int32 Cores = Count > FPlatformMisc::NumberOfCoresIncludingHyperthreads() ? FPlatformMisc::NumberOfCoresIncludingHyperthreads() : 1;
 		const int32 ChunkSize = FMath::FloorToInt((static_cast<double>(Count) / static_cast<double>(Cores)));
@@ -375,12 +419,9 @@ void FMeshMorpherWrapper::CreateDeltasForVertexPairs(const TArray<FMeshMorpherWr
 				NewDelta.PositionDelta = FVector3f::ZeroVector;
 				NewDelta.SourceIdx = static_cast<uint32>(VertexPair.TargetIndex);
 
-				for(const FMorphTargetDelta& Delta : BaseDeltas)
+				if (BaseDeltaSums.IsValidIndex(VertexPair.SourceIndex))
 				{
-					if (Delta.SourceIdx == static_cast<uint32>(VertexPair.SourceIndex))
-					{
-						NewDelta.PositionDelta += Delta.PositionDelta;
-					}
+					NewDelta.PositionDelta = BaseDeltaSums[VertexPair.SourceIndex];
 				}
 
 				if (NewDelta.PositionDelta.Length() > 0.0f)
@@ -412,6 +453,21 @@ void FMeshMorpherWrapper::CalculateDynamicMeshesForTransfer(const FDynamicMesh3&
 	const int32 Count = TargetDynamicMesh.VertexCount();
 	if(Count > 0)
 	{
+		//Source vertices are bucketed by the correspondence threshold, so each lookup only visits the neighbouring cells
+		TPointHashGrid3d<int32> SourceGrid(FMath::Max(VertexThreshold, static_cast<double>(KINDA_SMALL_NUMBER)), INDEX_NONE);
+		for (const int32 SourceIndex : SourceDynamicMesh.VertexIndicesItr())
+		{
+			SourceGrid.InsertPointUnsafe(SourceIndex, SourceDynamicMesh.GetVertex(SourceIndex));
+		}
+
+		//Identical target vertices are within FVector::Equals tolerance of each other, a small cell keeps the buckets sparse
+		const double IdenticalRadius = 2.0 * KINDA_SMALL_NUMBER;
+		TPointHashGrid3d<int32> TargetGrid(0.1, INDEX_NONE);
+		for (const int32 TargetIndex : TargetDynamicMesh.VertexIndicesItr())
+		{
+			TargetGrid.InsertPointUnsafe(TargetIndex, TargetDynamicMesh.GetVertex(TargetIndex));
+		}
+
 		const int32 Cores = Count > FPlatformMisc::NumberOfCoresIncludingHyperthreads() ? FPlatformMisc::NumberOfCoresIncludingHyperthreads() : 1;
 		const int32 ChunkSize = FMath::FloorToInt((static_cast<double>(Count) / static_cast<double>(Cores)));
 		const int32 LastChunkSize = Count - (ChunkSize * Cores);
@@ -422,52 +478,49 @@ void FMeshMorpherWrapper::CalculateDynamicMeshesForTransfer(const FDynamicMesh3&
 			TArray<TSet<int32>> LocalVerticeSets;
 			TArray<FMeshMorpherWrapPair> LocalVertexPairs;
 			TArray<int32> LocalNoCorrespondent;
+			TArray<int32> IdenticalCandidates;
 			const int32 IterationSize = ((LastChunkSize > 0) && (ChunkIndex == Chunks - 1)) ? LastChunkSize : ChunkSize;
 			for (int X = 0; X < IterationSize; ++X)
 			{
 				TSet<int32>& VerticeSet = LocalVerticeSets.Add_GetRef(TSet<int32>());
 				const int32 TargetIndex = (ChunkIndex * ChunkSize) + X;
 
+				if (!TargetDynamicMesh.IsVertex(TargetIndex))
+				{
+					LocalNoCorrespondent.Add(TargetIndex);
+					continue;
+				}
+
 				const FVector TargetPosition = TargetDynamicMesh.GetVertex(TargetIndex);
 				const FVector TargetNormal = FVector(TargetDynamicMesh.GetVertexNormal(TargetIndex));
-				for (int32 NextTargetIndex = TargetIndex; NextTargetIndex < Count; NextTargetIndex++)
+
+				IdenticalCandidates.Reset();
+				TargetGrid.FindPointsInBall(TargetPosition, IdenticalRadius, [&](const int32& Other)
+				{
+					return FVector::DistSquared(TargetDynamicMesh.GetVertex(Other), TargetPosition);
+				}, IdenticalCandidates);
+
+				for (const int32 NextTargetIndex : IdenticalCandidates)
 				{
-					if (TargetDynamicMesh.IsVertex(TargetIndex) && TargetDynamicMesh.IsVertex(NextTargetIndex))
+					if (NextTargetIndex >= TargetIndex && NextTargetIndex < Count && TargetPosition.Equals(TargetDynamicMesh.GetVertex(NextTargetIndex)))
 					{
-						if (TargetDynamicMesh.GetVertex(TargetIndex).Equals(TargetDynamicMesh.GetVertex(NextTargetIndex)))
-						{
-							VerticeSet.Add(TargetIndex);
-							VerticeSet.Add(NextTargetIndex);
-						}
+						VerticeSet.Add(TargetIndex);
+						VerticeSet.Add(NextTargetIndex);
 					}
 				}
 
-				double LastDistance = TNumericLimits<double>::Max();
-				int32 ClosestCompatibleIndex = INDEX_NONE;
-
-				for (int32 SourceIndex = 0; SourceIndex < SourceDynamicMesh.VertexCount(); SourceIndex++)
+				const TPair<int32, double> Closest = SourceGrid.FindNearestInRadius(TargetPosition, VertexThreshold, [&](const int32& SourceIndex)
 				{
-					if (SourceDynamicMesh.IsVertex(SourceIndex) && TargetDynamicMesh.IsVertex(TargetIndex))
-					{
-						const FVector SourceNormal = FVector(SourceDynamicMesh.GetVertexNormal(SourceIndex));
-						const bool TriangleNormalCompatibility = FMath::Max(0, (SourceNormal.Dot(TargetNormal) - NormalIncompatibilityThreshold) * NormalIncompatibilityMultiplier) > 0.0;
-						
-						if(TriangleNormalCompatibility)
-						{
-							const FVector SourcePosition = SourceDynamicMesh.GetVertex(SourceIndex);
-							const double Distance = (SourcePosition - TargetPosition).Size();
-							if (Distance < VertexThreshold && Distance < LastDistance)
-							{
-								LastDistance = Distance;
-								ClosestCompatibleIndex = SourceIndex;
-							}
-						}
-					}
-				}	
+					return FVector::DistSquared(SourceDynamicMesh.GetVertex(SourceIndex), TargetPosition);
+				}, [&](const int32& SourceIndex)
+				{
+					const FVector SourceNormal = FVector(SourceDynamicMesh.GetVertexNormal(SourceIndex));
+					return !(FMath::Max(0, (SourceNormal.Dot(TargetNormal) - NormalIncompatibilityThreshold) * NormalIncompatibilityMultiplier) > 0.0);
+				});
 
-				if(ClosestCompatibleIndex > INDEX_NONE)
+				if(Closest.Key > INDEX_NONE)
 				{
-					LocalVertexPairs.Add(FMeshMorpherWrapPair(TargetIndex, ClosestCompatibleIndex));
+					LocalVertexPairs.Add(FMeshMorpherWrapPair(TargetIndex, Closest.Key));
 				} else
 				{
 					LocalNoCorrespondent.Add(TargetIndex);
@@ -8,6 +8,7 @@
 #include "Animation/Skeleton.h"
 #include "GenericQuadTree.h"
 #include "Async/ParallelFor.h"
+#include "Async/Async.h"
 #include "Modules/ModuleManager.h"
 #include "Misc/PackageName.h"
 #include "IAssetTools.h"
@@ -24,6 +25,7 @@
 #include "MeshUtilities.h"
 #include "Misc/FeedbackContext.h"
 #include "DynamicMesh/Operations/MergeCoincidentMeshEdges.h"
+#include "Spatial/PointHashGrid3.h"
 #ifndef ENGINE_MINOR_VERSION
 #include "Runtime/Launch/Resources/Version.h"
 #endif
@@ -2008,7 +2010,28 @@ int32 UMeshOperationsLibrary::CreateMorphTargetFromDynamicMeshes(const FDynamicM
 
 		OutDeltas.Empty();
 		GWarn->StatusForceUpdate(4, 5, FText::FromString("Applying Morph Target Deltas to Dynamic Mesh ..."));
-		ApplySourceDeltasToDynamicMesh(BaseMesh, DynamicMesh, InitialDeltas, TSet<int32>(), OutDeltas, Threshold, NormalIncompatibilityThreshold, Multiplier, SmoothIterations, SmoothStrength, true);
+		if (FMeshMorpherWrapper::IsDynamicMeshTopologyIdentical(BaseMesh, DynamicMesh) && FMeshMorpherWrapper::IsDynamicMeshTopologyIdentical(BaseMesh, MorphedMesh))
+		{
+			//Same vertex order as the skeletal mesh, the per index deltas already belong to it.
+			//Smoothing and the multiplier are applied in the same order as the projection path.
+			OutDeltas = MoveTemp(InitialDeltas);
+			for (int32 SmoothIndex = 0; SmoothIndex < SmoothIterations; SmoothIndex++)
+			{
+				FMeshMorpherWrapper::GetSmoothDeltas(DynamicMesh, OutDeltas, SmoothStrength, OutDeltas);
+			}
+
+			if (!FMath::IsNearlyEqual(Multiplier, 1.0))
+			{
+				ParallelFor(OutDeltas.Num(), [&](const int32 Index)
+				{
+					OutDeltas[Index].PositionDelta *= static_cast<float>(Multiplier);
+				});
+			}
+		}
+		else
+		{
+			ApplySourceDeltasToDynamicMesh(BaseMesh, DynamicMesh, InitialDeltas, TSet<int32>(), OutDeltas, Threshold, NormalIncompatibilityThreshold, Multiplier, SmoothIterations, SmoothStrength, true);
+		}
 
 
 		//UE_LOG(LogTemp, Warning, TEXT("Out Deltas Found. %d\n"), OutDeltas.Num());
@@ -2545,6 +2568,106 @@ bool UMeshOperationsLibrary::CreateMetaMorphAssetFromDynamicMeshes(const FDynami
 }
 
 
+//Welds coincident open borders, both the UV/section splits inside a part and the seams between appended parts.
+//Only boundary edges are put in the search grid, so interior geometry is never searched.
+static int32 WeldBoundaryEdges(FDynamicMesh3& DynamicMesh, const double MergeVertexTolerance, const double MergeSearchTolerance, const bool OnlyUniquePairs)
+{
+	TArray<int32> BoundaryEdges;
+	for (const int32 EdgeID : DynamicMesh.BoundaryEdgeIndicesItr())
+	{
+		BoundaryEdges.Add(EdgeID);
+	}
+
+	if (BoundaryEdges.Num() < 2)
+	{
+		return 0;
+	}
+
+	const double SearchRadius = FMath::Max(MergeSearchTolerance, static_cast<double>(KINDA_SMALL_NUMBER));
+	const double VertexToleranceSqr = MergeVertexTolerance * MergeVertexTolerance;
+
+	TPointHashGrid3d<int32> EdgeGrid(SearchRadius, INDEX_NONE);
+	for (const int32 EdgeID : BoundaryEdges)
+	{
+		EdgeGrid.InsertPointUnsafe(EdgeID, DynamicMesh.GetEdgePoint(EdgeID, 0.5));
+	}
+
+	TArray<int32> Matches;
+	Matches.Init(INDEX_NONE, BoundaryEdges.Num());
+
+	ParallelFor(BoundaryEdges.Num(), [&](const int32 Index)
+	{
+		const int32 EdgeID = BoundaryEdges[Index];
+		const FIndex2i EdgeV = DynamicMesh.GetEdgeV(EdgeID);
+		const FVector3d A = DynamicMesh.GetVertex(EdgeV.A);
+		const FVector3d B = DynamicMesh.GetVertex(EdgeV.B);
+		const FVector3d Midpoint = DynamicMesh.GetEdgePoint(EdgeID, 0.5);
+
+		auto IsCandidate = [&](const int32 OtherID)
+		{
+			const FIndex2i OtherV = DynamicMesh.GetEdgeV(OtherID);
+			//edges sharing a vertex belong to the same fan, merging them would fold it
+			if (OtherID == EdgeID || OtherV.A == EdgeV.A || OtherV.A == EdgeV.B || OtherV.B == EdgeV.A || OtherV.B == EdgeV.B)
+			{
+				return false;
+			}
+			const FVector3d C = DynamicMesh.GetVertex(OtherV.A);
+			const FVector3d D = DynamicMesh.GetVertex(OtherV.B);
+			return (FVector3d::DistSquared(A, D) <= VertexToleranceSqr && FVector3d::DistSquared(B, C) <= VertexToleranceSqr)
+				|| (FVector3d::DistSquared(A, C) <= VertexToleranceSqr && FVector3d::DistSquared(B, D) <= VertexToleranceSqr);
+		};
+
+		auto DistanceSqr = [&](const int32& OtherID)
+		{
+			return FVector3d::DistSquared(DynamicMesh.GetEdgePoint(OtherID, 0.5), Midpoint);
+		};
+
+		const TPair<int32, double> Closest = EdgeGrid.FindNearestInRadius(Midpoint, SearchRadius, DistanceSqr, [&](const int32& OtherID)
+		{
+			return !IsCandidate(OtherID);
+		});
+
+		if (Closest.Key == INDEX_NONE)
+		{
+			return;
+		}
+
+		if (OnlyUniquePairs)
+		{
+			const TPair<int32, double> Second = EdgeGrid.FindNearestInRadius(Midpoint, SearchRadius, DistanceSqr, [&](const int32& OtherID)
+			{
+				return OtherID == Closest.Key || !IsCandidate(OtherID);
+			});
+
+			if (Second.Key != INDEX_NONE)
+			{
+				return;
+			}
+		}
+
+		Matches[Index] = Closest.Key;
+	});
+
+	int32 MergedEdges = 0;
+	for (int32 Index = 0; Index < BoundaryEdges.Num(); ++Index)
+	{
+		const int32 EdgeID = BoundaryEdges[Index];
+		const int32 OtherID = Matches[Index];
+
+		//the reverse pair, or an edge consumed by an earlier merge, is no longer a boundary edge
+		if (OtherID != INDEX_NONE && DynamicMesh.IsEdge(EdgeID) && DynamicMesh.IsEdge(OtherID) && DynamicMesh.IsBoundaryEdge(EdgeID) && DynamicMesh.IsBoundaryEdge(OtherID))
+		{
+			FDynamicMesh3::FMergeEdgesInfo MergeInfo;
+			if (DynamicMesh.MergeEdges(EdgeID, OtherID, MergeInfo) == EMeshResult::Ok)
+			{
+				MergedEdges++;
+			}
+		}
+	}
+
+	return MergedEdges;
+}
+
 bool UMeshOperationsLibrary::AppenedMeshes(USkeletalMesh* SkeletalMesh, TArray<USkeletalMesh*> AdditionalSkeletalMeshes, const bool bWeldMesh, double MergeVertexTolerance, double MergeSearchTolerance, bool OnlyUniquePairs, bool bCreateAdditionalMeshesGroups, FDynamicMesh3& Output)
 {
 	if (!SkeletalMeshToDynamicMesh(SkeletalMesh, Output))
@@ -2581,15 +2704,13 @@ bool UMeshOperationsLibrary::AppenedMeshes(USkeletalMesh* SkeletalMesh, TArray<U
 		FDynamicMesh3 CurrentMesh;
 		if (SkeletalMeshToDynamicMesh(AdditionalSkeketalMesh, CurrentMesh))
 		{
-		
 			FMeshIndexMappings IndexMappingOriginal;
 			MainMeshEditor.AppendMesh(&CurrentMesh, IndexMappingOriginal);
-			Output.CompactInPlace();
 
 			if(bCreateAdditionalMeshesGroups)
 			{
 				int32 LocalGroupsCount = 0;
-				FDynamicMeshMaterialAttribute* CurrentMaterialID = NULL;
+				const FDynamicMeshMaterialAttribute* CurrentMaterialID = NULL;
 
 				if (CurrentMesh.HasAttributes() && CurrentMesh.Attributes()->HasMaterialID())
 				{
@@ -2604,7 +2725,8 @@ bool UMeshOperationsLibrary::AppenedMeshes(USkeletalMesh* SkeletalMesh, TArray<U
 					if (CurrentMaterialID && OutputMaterialID)
 					{
 						CurrentMaterialID->GetValue(TriangleID, &TriangleGroup);
-						OutputMaterialID->SetValue(NewTriID, &InitialGroupsCount + TriangleGroup);
+						const int32 NewTriangleGroup = InitialGroupsCount + TriangleGroup;
+						OutputMaterialID->SetValue(NewTriID, &NewTriangleGroup);
 					}
 
 					if(TriangleGroup > LocalGroupsCount)
@@ -2618,20 +2740,14 @@ bool UMeshOperationsLibrary::AppenedMeshes(USkeletalMesh* SkeletalMesh, TArray<U
 		}
 	}
 
-	
-
 	if(bWeldMesh)
 	{
-		FMergeCoincidentMeshEdges Merger(&Output);
-		Merger.MergeVertexTolerance = MergeVertexTolerance;
-		Merger.MergeSearchTolerance = MergeSearchTolerance;
-		Merger.OnlyUniquePairs = OnlyUniquePairs;
-		if (Merger.Apply())
-		{
-			Output.CompactInPlace();
-		}
+		WeldBoundaryEdges(Output, MergeVertexTolerance, MergeSearchTolerance, OnlyUniquePairs);
 	}
 
+	//vertex IDs stay stable until the borders are welded, so the mesh is compacted once at the end
+	Output.CompactInPlace();
+
 	if (FDynamicMeshNormalOverlay* Normals = Output.HasAttributes() ? Output.Attributes()->PrimaryNormals() : nullptr)
 	{
 		FMeshNormals::InitializeOverlayToPerVertexNormals(Normals);
@@ -2658,8 +2774,9 @@ bool UMeshOperationsLibrary::SkeletalMeshToSolidDynamicMesh(USkeletalMesh* Skele
 	return ConvertDynamicMeshToSolidDynamicMesh(OutMesh, Options, SubdivisionSteps, bWeldMesh, MergeVertexTolerance, MergeSearchTolerance, OnlyUniquePairs);
 }
 
-bool UMeshOperationsLibrary::ConvertDynamicMeshToSolidDynamicMesh(FDynamicMesh3& DynamicMesh, const FMeshMorpherSolidifyOptions& Options, const uint32 SubdivisionSteps, const bool bWeldMesh, const double MergeVertexTolerance, const double MergeSearchTolerance, const bool OnlyUniquePairs)
+static bool SolidifyDynamicMesh(FDynamicMesh3& DynamicMesh, const FMeshMorpherSolidifyOptions& Options, const uint32 SubdivisionSteps, const bool bWeldMesh, const double MergeVertexTolerance, const double MergeSearchTolerance, const bool OnlyUniquePairs, const TFunction<bool()>& CancelF, TAtomic<uint32>& CompletedSteps)
 {
+	FDynamicMesh3 SolidMesh;
 	FDynamicMesh3 SourceVoxelMesh = DynamicMesh;
 	{
 		FDynamicMeshAABBTree3 Spatial(&SourceVoxelMesh);
@@ -2671,8 +2788,15 @@ bool UMeshOperationsLibrary::ConvertDynamicMeshToSolidDynamicMesh(FDynamicMesh3&
 		Solidify.SurfaceSearchSteps = Options.SurfaceSearchSteps;
 		Solidify.bSolidAtBoundaries = Options.bSolidAtBoundaries;
 		Solidify.ExtendBounds = Options.ExtendBounds;
-		DynamicMesh.Copy(&Solidify.Generate());
+		Solidify.CancelF = CancelF;
+		SolidMesh.Copy(&Solidify.Generate());
+	}
+
+	if (CancelF())
+	{
+		return false;
 	}
+	++CompletedSteps;
 
 	if(bWeldMesh)
 	{
@@ -2688,13 +2812,90 @@ bool UMeshOperationsLibrary::ConvertDynamicMeshToSolidDynamicMesh(FDynamicMesh3&
 	
 	for(uint32 X = 0; X < SubdivisionSteps; ++X)
 	{
-		SubdivideMesh(DynamicMesh);
-		DynamicMesh.CompactInPlace();
+		if (CancelF())
+		{
+			return false;
+		}
+		SubdivideMesh(SolidMesh);
+		SolidMesh.CompactInPlace();
+		++CompletedSteps;
 	}
 
+	DynamicMesh = MoveTemp(SolidMesh);
 	return DynamicMesh.VertexCount() > 0;
 }
 
+uint64 UMeshOperationsLibrary::EstimateSolidifyMemory(const FDynamicMesh3& DynamicMesh, const FMeshMorpherSolidifyOptions& Options, const uint32 SubdivisionSteps)
+{
+	const FAxisAlignedBox3d Bounds = DynamicMesh.GetBounds();
+	if (Bounds.IsEmpty())
+	{
+		return 0;
+	}
+
+	const int32 ClampResolution = FMath::Clamp(Options.GridResolution, 4, Options.GridResolution);
+	const double CellSize = FMath::Max(Bounds.MaxDim() / static_cast<double>(ClampResolution), static_cast<double>(KINDA_SMALL_NUMBER));
+	const double Padding = 2.0 * (FMath::Max(static_cast<double>(Options.ExtendBounds), 0.0) + 1.0);
+
+	const uint64 CellsX = static_cast<uint64>(FMath::CeilToDouble(Bounds.Width() / CellSize) + Padding);
+	const uint64 CellsY = static_cast<uint64>(FMath::CeilToDouble(Bounds.Height() / CellSize) + Padding);
+	const uint64 CellsZ = static_cast<uint64>(FMath::CeilToDouble(Bounds.Depth() / CellSize) + Padding);
+
+	//Winding values plus the marching cubes edge vertex caches for every cell
+	const uint64 GridBytes = CellsX * CellsY * CellsZ * (sizeof(float) + 3 * sizeof(int32));
+
+	//The generated surface roughly follows the faces of the grid, and each subdivision step quadruples it.
+	//A dynamic mesh vertex with its two triangles, three edges and ref counts costs about 160 bytes.
+	const uint64 SurfaceVertices = 2 * (CellsX * CellsY + CellsY * CellsZ + CellsX * CellsZ) * (1ull << (2 * FMath::Min(SubdivisionSteps, 8u)));
+	const uint64 SurfaceBytes = SurfaceVertices * 160;
+
+	//The input mesh is copied once for the winding tree
+	const uint64 SourceBytes = static_cast<uint64>(DynamicMesh.MaxVertexID()) * 160;
+
+	return GridBytes + SurfaceBytes + SourceBytes;
+}
+
+bool UMeshOperationsLibrary::ConvertDynamicMeshToSolidDynamicMesh(FDynamicMesh3& DynamicMesh, const FMeshMorpherSolidifyOptions& Options, const uint32 SubdivisionSteps, const bool bWeldMesh, const double MergeVertexTolerance, const double MergeSearchTolerance, const bool OnlyUniquePairs)
+{
+	TAtomic<uint32> CompletedSteps(0);
+
+	if (!IsInGameThread())
+	{
+		return SolidifyDynamicMesh(DynamicMesh, Options, SubdivisionSteps, bWeldMesh, MergeVertexTolerance, MergeSearchTolerance, OnlyUniquePairs, []() { return false; }, CompletedSteps);
+	}
+
+	FFormatNamedArguments Args;
+	Args.Add(TEXT("Resolution"), FText::AsNumber(FMath::Clamp(Options.GridResolution, 4, Options.GridResolution)));
+	Args.Add(TEXT("Memory"), FText::AsMemory(EstimateSolidifyMemory(DynamicMesh, Options, SubdivisionSteps)));
+	const FText StatusUpdate = FText::Format(LOCTEXT("SolidifyDynamicMesh", "Solidifying mesh at resolution {Resolution} (estimated memory {Memory})..."), Args);
+	GWarn->BeginSlowTask(StatusUpdate, true);
+	if (!GWarn->GetScopeStack().IsEmpty())
+	{
+		GWarn->GetScopeStack().Last()->MakeDialog(true, true);
+	}
+
+	//The solidify and subdivision steps run on a worker, the game thread only pumps progress and polls for cancellation
+	FThreadSafeBool bCancelled = false;
+	const TFunction<bool()> CancelF = [&bCancelled]() { return static_cast<bool>(bCancelled); };
+	TFuture<bool> Result = Async(EAsyncExecution::ThreadPool, [&]()
+	{
+		return SolidifyDynamicMesh(DynamicMesh, Options, SubdivisionSteps, bWeldMesh, MergeVertexTolerance, MergeSearchTolerance, OnlyUniquePairs, CancelF, CompletedSteps);
+	});
+
+	const uint32 TotalSteps = SubdivisionSteps + 1;
+	while (!Result.WaitFor(FTimespan::FromMilliseconds(100.0)))
+	{
+		GWarn->StatusUpdate(static_cast<int32>(CompletedSteps.Load()), static_cast<int32>(TotalSteps), StatusUpdate);
+		if (GWarn->ReceivedUserCancel())
+		{
+			bCancelled = true;
+		}
+	}
+
+	GWarn->EndSlowTask();
+	return Result.Get() && !bCancelled;
+}
+
 bool UMeshOperationsLibrary::MorphMesh(USkeletalMesh* SourceSkeletalMesh, USkeletalMesh* TargetSkeletalMesh, TArray<FMorphTargetDelta>& OutDeltas)
 {
 	if(!SourceSkeletalMesh)
@@ -2786,11 +2987,14 @@ bool UMeshOperationsLibrary::MorphMesh(USkeletalMesh* SourceSkeletalMesh, USkele
 	FDynamicMeshAABBTree3 TargetSpatial(&TargetVoxelMesh);
 	FMeshProjectionTarget TargetMeshProjection(&TargetVoxelMesh, &TargetSpatial);
 
-	for(const int& VertexID : MergedTargetVoxelMesh.VertexIndicesItr())
+	ParallelFor(MergedTargetVoxelMesh.MaxVertexID(), [&](const int32 VertexID)
 	{
-		const FVector3d Position = MergedTargetVoxelMesh.GetVertex(VertexID);
-		MergedTargetVoxelMesh.SetVertex(VertexID, TargetMeshProjection.Project(Position), false);
-	}
+		if (MergedTargetVoxelMesh.IsVertex(VertexID))
+		{
+			const FVector3d Position = MergedTargetVoxelMesh.GetVertex(VertexID);
+			MergedTargetVoxelMesh.SetVertex(VertexID, TargetMeshProjection.Project(Position), false);
+		}
+	});
 
 
 	double NormalIncompatibilityThreshold = 0.5;
@@ -112,8 +112,15 @@ void UCreateMetaMorphFromFBXProperties::PostEditChangeProperty(FPropertyChangedE
 				}
 				GWarn->UpdateProgress(0, 1);
 				GWarn->StatusForceUpdate(1, 1, FText::FromString("Importing Mesh File ..."));
-				FMeshMorpherFBXImport FBXImport(BaseFile.FilePath, BaseFrontCoordinateSystem, BaseFrontAxis, BaseUpAxis, true, bBaseUseT0, FMath::Rand());
-				BaseMesh = FBXImport.DynamicMesh;
+				FMeshMorpherFBXImportResult ImportResult;
+				if (FMeshMorpherFBXImport::ImportFile(BaseFile.FilePath, BaseFrontCoordinateSystem, BaseFrontAxis, BaseUpAxis, true, bBaseUseT0, ImportResult))
+				{
+					BaseMesh = MoveTemp(ImportResult.DynamicMesh);
+				}
+				else
+				{
+					UMeshOperationsLibrary::NotifyMessage(FString::Printf(TEXT("Could not import %s: %s"), *FPaths::GetCleanFilename(ImportResult.FileName), *ImportResult.Error));
+				}
 				
 				GWarn->EndSlowTask();
 				if (RenderMeshes)
@@ -173,8 +180,15 @@ void UCreateMetaMorphFromFBXProperties::PostEditChangeProperty(FPropertyChangedE
 				}
 				GWarn->UpdateProgress(0, 1);
 				GWarn->StatusForceUpdate(1, 1, FText::FromString("Importing Mesh File ..."));
-				FMeshMorpherFBXImport FBXImport(MorphedFile.FilePath, MorphedFrontCoordinateSystem, MorphedFrontAxis, MorphedUpAxis, true, bMorphedUseT0, FMath::Rand());
-				MorphedMesh = FBXImport.DynamicMesh;
+				FMeshMorpherFBXImportResult ImportResult;
+				if (FMeshMorpherFBXImport::ImportFile(MorphedFile.FilePath, MorphedFrontCoordinateSystem, MorphedFrontAxis, MorphedUpAxis, true, bMorphedUseT0, ImportResult))
+				{
+					MorphedMesh = MoveTemp(ImportResult.DynamicMesh);
+				}
+				else
+				{
+					UMeshOperationsLibrary::NotifyMessage(FString::Printf(TEXT("Could not import %s: %s"), *FPaths::GetCleanFilename(ImportResult.FileName), *ImportResult.Error));
+				}
 				
 				GWarn->EndSlowTask();
 				if (RenderMeshes)
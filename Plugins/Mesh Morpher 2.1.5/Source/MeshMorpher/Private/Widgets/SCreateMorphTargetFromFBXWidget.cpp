@@ -117,8 +117,15 @@ void UCreateMorphTargetFromFBXProperties::PostEditChangeProperty(FPropertyChange
 				}
 				GWarn->UpdateProgress(0, 1);
 				GWarn->StatusForceUpdate(1, 1, FText::FromString("Importing Mesh File ..."));
-				FMeshMorpherFBXImport FBXImport(BaseFile.FilePath, BaseFrontCoordinateSystem, BaseFrontAxis, BaseUpAxis, true, bBaseUseT0, FMath::Rand());
-				BaseMesh = FBXImport.DynamicMesh;
+				FMeshMorpherFBXImportResult ImportResult;
+				if (FMeshMorpherFBXImport::ImportFile(BaseFile.FilePath, BaseFrontCoordinateSystem, BaseFrontAxis, BaseUpAxis, true, bBaseUseT0, ImportResult))
+				{
+					BaseMesh = MoveTemp(ImportResult.DynamicMesh);
+				}
+				else
+				{
+					UMeshOperationsLibrary::NotifyMessage(FString::Printf(TEXT("Could not import %s: %s"), *FPaths::GetCleanFilename(ImportResult.FileName), *ImportResult.Error));
+				}
 				
 				GWarn->EndSlowTask();
 				if (RenderMeshes)
@@ -178,8 +185,15 @@ void UCreateMorphTargetFromFBXProperties::PostEditChangeProperty(FPropertyChange
 				}
 				GWarn->UpdateProgress(0, 1);
 				GWarn->StatusForceUpdate(1, 1, FText::FromString("Importing Mesh File ..."));
-				FMeshMorpherFBXImport FBXImport(MorphedFile.FilePath, MorphedFrontCoordinateSystem, MorphedFrontAxis, MorphedUpAxis, true, bMorphedUseT0, FMath::Rand());
-				MorphedMesh = FBXImport.DynamicMesh;
+				FMeshMorpherFBXImportResult ImportResult;
+				if (FMeshMorpherFBXImport::ImportFile(MorphedFile.FilePath, MorphedFrontCoordinateSystem, MorphedFrontAxis, MorphedUpAxis, true, bMorphedUseT0, ImportResult))
+				{
+					MorphedMesh = MoveTemp(ImportResult.DynamicMesh);
+				}
+				else
+				{
+					UMeshOperationsLibrary::NotifyMessage(FString::Printf(TEXT("Could not import %s: %s"), *FPaths::GetCleanFilename(ImportResult.FileName), *ImportResult.Error));
+				}
 				
 				GWarn->EndSlowTask();
 				if (RenderMeshes)
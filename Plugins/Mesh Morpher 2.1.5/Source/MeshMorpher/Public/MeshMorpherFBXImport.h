@@ -24,12 +24,49 @@ enum class EMeshMorpherFBXAxis : uint8
 };
 
 
+/** Geometry of one FBX mesh node without any SDK types, so it can be converted off the game thread */
+struct FMeshMorpherFBXRawMesh
+{
+	int32 GroupID = 0;
+	/** Transformed and converted position of every control point */
+	TArray<FVector> Positions;
+	/** Control point indices of all triangles and quads, PolygonSizes[i] corners each */
+	TArray<int32> PolygonCorners;
+	TArray<uint8> PolygonSizes;
+};
+
+struct FMeshMorpherFBXImportResult
+{
+	FString FileName;
+	FDynamicMesh3 DynamicMesh;
+	bool bSuccess = false;
+	double ParseSeconds = 0.0;
+	double ConvertSeconds = 0.0;
+	/** Mesh nodes with at least one triangle or quad */
+	int32 NumMeshNodes = 0;
+	/** Polygons that are neither triangles nor quads */
+	int32 NumSkippedPolygons = 0;
+	FString Error;
+};
+
 class FMeshMorpherFBXImport
 {
 
 public:
-	FMeshMorpherFBXImport(const FString FileName, EMeshMorpherFBXCoordinate Coordinate, EMeshMorpherFBXAxis FrontVector, EMeshMorpherFBXAxis UpVector, const bool bConvertScene, const bool UseT0, const int32 ImportID);
+	FMeshMorpherFBXImport(const FString FileName, EMeshMorpherFBXCoordinate Coordinate, EMeshMorpherFBXAxis FrontVector, EMeshMorpherFBXAxis UpVector, const bool bConvertScene, const bool UseT0, const int32 ImportID, const bool bBuildDynamicMesh = true);
 	~FMeshMorpherFBXImport();
+
+	/**
+	 * Import several files with the same settings. Scenes are parsed serially, conversion to FDynamicMesh3 runs on worker threads.
+	 * OutResults matches FileNames and holds the mesh, timings and diagnostics of each file.
+	 * OBJ files are read with UMeshMorpherToolHelper::ImportOBJFileToDynamicMesh, so vertex IDs follow the file and the axis settings are ignored.
+	 */
+	static void ImportFiles(const TArray<FString>& FileNames, EMeshMorpherFBXCoordinate Coordinate, EMeshMorpherFBXAxis FrontVector, EMeshMorpherFBXAxis UpVector, const bool bConvertScene, const bool UseT0, TArray<FMeshMorpherFBXImportResult>& OutResults);
+
+	/** ImportFiles for a single file, @return true if the file produced at least one triangle */
+	static bool ImportFile(const FString& FileName, EMeshMorpherFBXCoordinate Coordinate, EMeshMorpherFBXAxis FrontVector, EMeshMorpherFBXAxis UpVector, const bool bConvertScene, const bool UseT0, FMeshMorpherFBXImportResult& OutResult);
+
+	static void BuildDynamicMesh(const TArray<FMeshMorpherFBXRawMesh>& InRawMeshes, FDynamicMesh3& OutMesh);
 public:
 	FDynamicMesh3 DynamicMesh;
 private:
@@ -43,10 +80,13 @@ private:
 	void InitializeFBXMesh(const FString& FileName, int32 ImportID);
 	FbxAMatrix ComputeTotalMatrix(FbxNode* Node) const;
 	void GetVertexArray(FbxMesh* FbxMesh, TArray<FbxVector4>& VertexArray) const;
-	void CreateSingleFBXMesh(const int32 i);
+	void ExtractSingleFBXMesh(const int32 i, FMeshMorpherFBXRawMesh& OutRawMesh);
 private:
 	FbxMap<FbxString, TSharedPtr< FbxArray<FbxNode* > > > CollisionModels;
 	bool bCurrentConvertScene = false;
+	bool bSceneImported = false;
+	int32 NumSkippedPolygons = 0;
+	TArray<FMeshMorpherFBXRawMesh> RawMeshes;
 	bool bUseT0 = false;
 	FVector CurrentFBXAxis;
 	
@@ -33,11 +33,14 @@ public:
 	double NormalIncompatibilityThreshold = 0.5;
 public:
 	static bool IsDynamicMeshIdentical(const FDynamicMesh3& DynamicMeshA, const FDynamicMesh3& DynamicMeshB);
+	/** Same vertex and triangle counts and the same index buffer, positions are ignored */
+	static bool IsDynamicMeshTopologyIdentical(const FDynamicMesh3& DynamicMeshA, const FDynamicMesh3& DynamicMeshB);
 	bool ProjectDeltas(const TArray<FMorphTargetDelta>& InDeltas, const bool bCheckMeshesIdentical, const double Multiplier, const int32 SmoothIterations, const double SmoothStrength, TArray<FMorphTargetDelta>& OutDeltas) const;
 	bool ProjectMesh(const bool bCheckMeshesIdentical, const double Multiplier, const int32 SmoothIterations, const double SmoothStrength, TArray<FMorphTargetDelta>& OutDeltas) const;
+	/** One smoothing pass of Deltas over the triangles of TargetDynamicMesh, Deltas and OutSmoothDeltas may be the same array */
+	static void GetSmoothDeltas(const FDynamicMesh3& TargetDynamicMesh, TArray<FMorphTargetDelta>& Deltas, const double& SmoothStrength, TArray<FMorphTargetDelta>& OutSmoothDeltas);
 private:
 	void ComputeDeltaProjection(const FDynamicMesh3& SourceDynamicMesh, FDynamicMesh3 TargetDynamicMesh, const TArray<FMorphTargetDelta>& InDeltas, const double Multiplier, const int32 SmoothIterations, const double SmoothStrength, TArray<FMorphTargetDelta>& OutDeltas) const;
-	void GetSmoothDeltas(const FDynamicMesh3& TargetDynamicMesh, TArray<FMorphTargetDelta>& Deltas, const double& SmoothStrength, TArray<FMorphTargetDelta>& OutSmoothDeltas) const;
 	void ApplyDeltasToIdenticalVertices(const TArray<TSet<int32>>& VerticesSets, TArray<FMorphTargetDelta>& Deltas) const;
 	void CreateDeltasForVertexPairs(const TArray<FMeshMorpherWrapPair>& VertexPairs, const TArray<FMorphTargetDelta>& BaseDeltas, TArray<FMorphTargetDelta>& OutDeltas) const;
 	void CalculateDynamicMeshesForTransfer(const FDynamicMesh3& SourceDynamicMesh, const FDynamicMesh3& TargetDynamicMesh, TArray<TSet<int32>>& VerticesSets, TArray<FMeshMorpherWrapPair>& VertexPairs, TArray<int32>& NoCorrespondent) const;
@@ -82,6 +82,7 @@ public:
 	static bool CreateMetaMorphAssetFromDynamicMeshes(const FDynamicMesh3& BaseMesh, const FDynamicMesh3& MorphedMesh, FString MorphName, const TArray< UStandaloneMaskSelection*>& IgnoreMasks = TArray< UStandaloneMaskSelection*>(), const TArray< UStandaloneMaskSelection*>& MoveMasks = TArray< UStandaloneMaskSelection*>());
 	static bool AppenedMeshes(USkeletalMesh* SkeletalMesh, TArray<USkeletalMesh*> AdditionalSkeletalMeshes, const bool bWeldMesh, double MergeVertexTolerance, double MergeSearchTolerance, bool OnlyUniquePairs, bool bCreateAdditionalMeshesGroups, FDynamicMesh3& Output);
 	static bool SkeletalMeshToSolidDynamicMesh(USkeletalMesh* SkeletalMesh, const FMeshMorpherSolidifyOptions& Options, FDynamicMesh3& OutMesh, const uint32 SubdivisionSteps = 0, const bool bWeldMesh = false, const double MergeVertexTolerance = 0.0, const double MergeSearchTolerance = 0.0, const bool OnlyUniquePairs = false);
+	static uint64 EstimateSolidifyMemory(const FDynamicMesh3& DynamicMesh, const FMeshMorpherSolidifyOptions& Options, const uint32 SubdivisionSteps = 0);
 	static bool ConvertDynamicMeshToSolidDynamicMesh(FDynamicMesh3& DynamicMesh, const FMeshMorpherSolidifyOptions& Options, const uint32 SubdivisionSteps = 0, const bool bWeldMesh = false, const double MergeVertexTolerance = 0.0, const double MergeSearchTolerance = 0.0, const bool OnlyUniquePairs = false);
 	static bool MorphMesh(USkeletalMesh* SourceSkeletalMesh, USkeletalMesh* TargetSkeletalMesh, TArray<FMorphTargetDelta>& OutDeltas);
 };
\ No newline at end of file
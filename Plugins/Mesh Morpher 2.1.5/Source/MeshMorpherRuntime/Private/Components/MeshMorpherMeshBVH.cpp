@@ -0,0 +1,413 @@
+// Copyright 2020-2022 SC Pug Life Studio S.R.L. All Rights Reserved.
+#include "Components/MeshMorpherMeshBVH.h"
+#include "Async/ParallelFor.h"
+#include "Distance/DistPoint3Triangle3.h"
+#include "Intersection/IntrRay3Triangle3.h"
+
+void FMeshMorpherMeshBVH::Build(const FDynamicMesh3* InMesh)
+{
+	Reset();
+	Mesh = InMesh;
+	if (!Mesh || Mesh->TriangleCount() == 0)
+	{
+		return;
+	}
+
+	TopologyChangeStamp = Mesh->GetTopologyChangeStamp();
+
+	const int32 MaxTriangleID = Mesh->MaxTriangleID();
+	TArray<FVector3d> Centroids;
+	Centroids.SetNumUninitialized(MaxTriangleID);
+	Triangles.Reserve(Mesh->TriangleCount());
+	for (const int32 TriangleID : Mesh->TriangleIndicesItr())
+	{
+		Triangles.Add(TriangleID);
+		Centroids[TriangleID] = Mesh->GetTriCentroid(TriangleID);
+	}
+	TriangleLeaves.Init(INDEX_NONE, MaxTriangleID);
+
+	//top down split at the middle of the centroid bounds longest axis, nodes are appended parents first
+	const int32 MaxLeafTriangles = FMath::Max(LeafTriangleCount, 1);
+	Nodes.Reserve(2 * FMath::DivideAndRoundUp(Triangles.Num(), MaxLeafTriangles));
+	Nodes.AddDefaulted();
+	Nodes[0].TriangleStart = 0;
+	Nodes[0].TriangleCount = Triangles.Num();
+
+	TArray<int32> Pending;
+	Pending.Add(0);
+	while (Pending.Num() > 0)
+	{
+		const int32 NodeIndex = Pending.Pop(false);
+		const int32 Start = Nodes[NodeIndex].TriangleStart;
+		const int32 Count = Nodes[NodeIndex].TriangleCount;
+
+		if (Count <= MaxLeafTriangles)
+		{
+			for (int32 Index = Start; Index < Start + Count; ++Index)
+			{
+				TriangleLeaves[Triangles[Index]] = NodeIndex;
+			}
+			continue;
+		}
+
+		FAxisAlignedBox3d CentroidBox = FAxisAlignedBox3d::Empty();
+		for (int32 Index = Start; Index < Start + Count; ++Index)
+		{
+			CentroidBox.Contain(Centroids[Triangles[Index]]);
+		}
+		const FVector3d Extents = CentroidBox.Max - CentroidBox.Min;
+		const int32 Axis = (Extents.X >= Extents.Y && Extents.X >= Extents.Z) ? 0 : (Extents.Y >= Extents.Z ? 1 : 2);
+		const double Split = (CentroidBox.Min[Axis] + CentroidBox.Max[Axis]) * 0.5;
+
+		int32 Middle = Start;
+		for (int32 Index = Start; Index < Start + Count; ++Index)
+		{
+			if (Centroids[Triangles[Index]][Axis] < Split)
+			{
+				Swap(Triangles[Index], Triangles[Middle]);
+				++Middle;
+			}
+		}
+
+		//coincident centroids, split by count instead
+		if (Middle == Start || Middle == Start + Count)
+		{
+			Middle = Start + Count / 2;
+		}
+
+		const int32 Child = Nodes.AddDefaulted(2);
+		Nodes[Child].Parent = NodeIndex;
+		Nodes[Child].TriangleStart = Start;
+		Nodes[Child].TriangleCount = Middle - Start;
+		Nodes[Child + 1].Parent = NodeIndex;
+		Nodes[Child + 1].TriangleStart = Middle;
+		Nodes[Child + 1].TriangleCount = Start + Count - Middle;
+
+		Nodes[NodeIndex].Child = Child;
+		Nodes[NodeIndex].TriangleStart = 0;
+		Nodes[NodeIndex].TriangleCount = 0;
+
+		Pending.Add(Child);
+		Pending.Add(Child + 1);
+	}
+
+	RefitAll();
+	BuildSurfaceArea = SurfaceArea;
+}
+
+void FMeshMorpherMeshBVH::Reset()
+{
+	Mesh = nullptr;
+	Nodes.Empty();
+	Triangles.Empty();
+	TriangleLeaves.Empty();
+	BuildSurfaceArea = 0.0;
+	SurfaceArea = 0.0;
+	TopologyChangeStamp = 0;
+}
+
+bool FMeshMorpherMeshBVH::NeedsRebuild() const
+{
+	if (!Mesh)
+	{
+		return false;
+	}
+
+	if (!IsValid() || Mesh->GetTopologyChangeStamp() != TopologyChangeStamp)
+	{
+		return true;
+	}
+	return SurfaceArea > BuildSurfaceArea * MaxQualityRatio;
+}
+
+void FMeshMorpherMeshBVH::Refit(const TArray<int32>& ModifiedVertices)
+{
+	if (!IsValid())
+	{
+		return;
+	}
+
+	TBitArray<> DirtyNodes(false, Nodes.Num());
+	TArray<int32> Leaves;
+	for (const int32 VertexID : ModifiedVertices)
+	{
+		if (Mesh->IsVertex(VertexID))
+		{
+			for (const int32 TriangleID : Mesh->VtxTrianglesItr(VertexID))
+			{
+				const int32 Leaf = TriangleLeaves.IsValidIndex(TriangleID) ? TriangleLeaves[TriangleID] : INDEX_NONE;
+				if (Leaf != INDEX_NONE && !DirtyNodes[Leaf])
+				{
+					Leaves.Add(Leaf);
+					for (int32 NodeIndex = Leaf; NodeIndex != INDEX_NONE && !DirtyNodes[NodeIndex]; NodeIndex = Nodes[NodeIndex].Parent)
+					{
+						DirtyNodes[NodeIndex] = true;
+					}
+				}
+			}
+		}
+	}
+
+	RefitLeaves(Leaves);
+	RefitInterior(DirtyNodes);
+}
+
+void FMeshMorpherMeshBVH::RefitAll()
+{
+	if (!IsValid())
+	{
+		return;
+	}
+
+	TArray<int32> Leaves;
+	for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
+	{
+		if (Nodes[NodeIndex].IsLeaf())
+		{
+			Leaves.Add(NodeIndex);
+		}
+	}
+
+	RefitLeaves(Leaves);
+	RefitInterior(TBitArray<>(true, Nodes.Num()));
+}
+
+void FMeshMorpherMeshBVH::Update(const TArray<int32>& ModifiedVertices)
+{
+	if (NeedsRebuild())
+	{
+		Build(Mesh);
+	}
+	else if (ModifiedVertices.Num() > 0)
+	{
+		Refit(ModifiedVertices);
+	}
+	else
+	{
+		RefitAll();
+	}
+}
+
+FAxisAlignedBox3d FMeshMorpherMeshBVH::GetTriangleBox(const int32 TriangleID) const
+{
+	FVector3d A, B, C;
+	Mesh->GetTriVertices(TriangleID, A, B, C);
+	FAxisAlignedBox3d Box(A, B);
+	Box.Contain(C);
+	return Box;
+}
+
+void FMeshMorpherMeshBVH::RefitLeaves(const TArray<int32>& Leaves)
+{
+	const int32 Count = Leaves.Num();
+	if(Count > 0)
+	{
+		const int32 Cores = Count > FPlatformMisc::NumberOfCoresIncludingHyperthreads() ? FPlatformMisc::NumberOfCoresIncludingHyperthreads() : 1;
+		const int32 ChunkSize = FMath::FloorToInt((static_cast<double>(Count) / static_cast<double>(Cores)));
+		const int32 LastChunkSize = Count - (ChunkSize * Cores);
+		const int32 Chunks = LastChunkSize > 0 ? Cores + 1 : Cores;
+
+		TArray<double> ChunkAreas;
+		ChunkAreas.SetNumZeroed(Chunks);
+
+		ParallelFor(Chunks, [&](const int32 ChunkIndex)
+		{
+			const int32 IterationSize = ((LastChunkSize > 0) && (ChunkIndex == Chunks - 1)) ? LastChunkSize : ChunkSize;
+			for (int X = 0; X < IterationSize; ++X)
+			{
+				const int32 Index = (ChunkIndex * ChunkSize) + X;
+				FNode& Node = Nodes[Leaves[Index]];
+
+				FAxisAlignedBox3d Box = FAxisAlignedBox3d::Empty();
+				for (int32 Slot = Node.TriangleStart; Slot < Node.TriangleStart + Node.TriangleCount; ++Slot)
+				{
+					Box.Contain(GetTriangleBox(Triangles[Slot]));
+				}
+				ChunkAreas[ChunkIndex] += GetSurfaceArea(Box) - GetSurfaceArea(Node.Box);
+				Node.Box = Box;
+			}
+		});
+
+		for (const double Area : ChunkAreas)
+		{
+			SurfaceArea += Area;
+		}
+	}
+}
+
+void FMeshMorpherMeshBVH::RefitInterior(const TBitArray<>& DirtyNodes)
+{
+	for (int32 NodeIndex = Nodes.Num() - 1; NodeIndex >= 0; --NodeIndex)
+	{
+		FNode& Node = Nodes[NodeIndex];
+		if (DirtyNodes[NodeIndex] && !Node.IsLeaf())
+		{
+			FAxisAlignedBox3d Box = Nodes[Node.Child].Box;
+			Box.Contain(Nodes[Node.Child + 1].Box);
+			SurfaceArea += GetSurfaceArea(Box) - GetSurfaceArea(Node.Box);
+			Node.Box = Box;
+		}
+	}
+}
+
+double FMeshMorpherMeshBVH::GetSurfaceArea(const FAxisAlignedBox3d& Box)
+{
+	if (Box.IsEmpty())
+	{
+		return 0.0;
+	}
+	const FVector3d Extents = Box.Max - Box.Min;
+	return 2.0 * (Extents.X * Extents.Y + Extents.Y * Extents.Z + Extents.Z * Extents.X);
+}
+
+bool FMeshMorpherMeshBVH::IntersectRayBox(const UE::Geometry::TRay<double>& Ray, const FVector3d& InvDirection, const FAxisAlignedBox3d& Box, const double MaxDistance, double& OutDistance)
+{
+	double Near = 0.0;
+	double Far = MaxDistance;
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		double T0 = (Box.Min[Axis] - Ray.Origin[Axis]) * InvDirection[Axis];
+		double T1 = (Box.Max[Axis] - Ray.Origin[Axis]) * InvDirection[Axis];
+		if (T0 > T1)
+		{
+			Swap(T0, T1);
+		}
+		Near = FMath::Max(Near, T0);
+		Far = FMath::Min(Far, T1);
+		if (Near > Far)
+		{
+			return false;
+		}
+	}
+	OutDistance = Near;
+	return true;
+}
+
+int32 FMeshMorpherMeshBVH::FindNearestHitTriangle(const UE::Geometry::TRay<double>& Ray, double& OutHitDistance, TFunctionRef<bool(int32)> TriangleFilter) const
+{
+	int32 HitTriangle = IndexConstants::InvalidID;
+	OutHitDistance = TNumericLimits<double>::Max();
+	if (!IsValid())
+	{
+		return HitTriangle;
+	}
+
+	const FVector3d InvDirection(
+		Ray.Direction.X != 0.0 ? 1.0 / Ray.Direction.X : TNumericLimits<double>::Max(),
+		Ray.Direction.Y != 0.0 ? 1.0 / Ray.Direction.Y : TNumericLimits<double>::Max(),
+		Ray.Direction.Z != 0.0 ? 1.0 / Ray.Direction.Z : TNumericLimits<double>::Max());
+
+	TArray<TPair<int32, double>, TInlineAllocator<64>> Stack;
+	double RootDistance;
+	if (IntersectRayBox(Ray, InvDirection, Nodes[0].Box, OutHitDistance, RootDistance))
+	{
+		Stack.Add(TPair<int32, double>(0, RootDistance));
+	}
+
+	while (Stack.Num() > 0)
+	{
+		const TPair<int32, double> Entry = Stack.Pop(false);
+		if (Entry.Value > OutHitDistance)
+		{
+			continue;
+		}
+
+		const FNode& Node = Nodes[Entry.Key];
+		if (Node.IsLeaf())
+		{
+			for (int32 Slot = Node.TriangleStart; Slot < Node.TriangleStart + Node.TriangleCount; ++Slot)
+			{
+				const int32 TriangleID = Triangles[Slot];
+				if (!TriangleFilter(TriangleID))
+				{
+					continue;
+				}
+
+				FTriangle3d Triangle;
+				Mesh->GetTriVertices(TriangleID, Triangle.V[0], Triangle.V[1], Triangle.V[2]);
+				FIntrRay3Triangle3d Query(Ray, Triangle);
+				if (Query.Find() && Query.RayParameter < OutHitDistance)
+				{
+					OutHitDistance = Query.RayParameter;
+					HitTriangle = TriangleID;
+				}
+			}
+		}
+		else
+		{
+			//push the farther child first so the nearer one is visited first
+			double DistanceA, DistanceB;
+			const bool bHitA = IntersectRayBox(Ray, InvDirection, Nodes[Node.Child].Box, OutHitDistance, DistanceA);
+			const bool bHitB = IntersectRayBox(Ray, InvDirection, Nodes[Node.Child + 1].Box, OutHitDistance, DistanceB);
+			if (bHitA && bHitB)
+			{
+				const bool bAFirst = DistanceA <= DistanceB;
+				Stack.Add(bAFirst ? TPair<int32, double>(Node.Child + 1, DistanceB) : TPair<int32, double>(Node.Child, DistanceA));
+				Stack.Add(bAFirst ? TPair<int32, double>(Node.Child, DistanceA) : TPair<int32, double>(Node.Child + 1, DistanceB));
+			}
+			else if (bHitA)
+			{
+				Stack.Add(TPair<int32, double>(Node.Child, DistanceA));
+			}
+			else if (bHitB)
+			{
+				Stack.Add(TPair<int32, double>(Node.Child + 1, DistanceB));
+			}
+		}
+	}
+	return HitTriangle;
+}
+
+int32 FMeshMorpherMeshBVH::FindNearestHitTriangle(const UE::Geometry::TRay<double>& Ray, double& OutHitDistance) const
+{
+	return FindNearestHitTriangle(Ray, OutHitDistance, [](const int32 TriangleID) { return true; });
+}
+
+int32 FMeshMorpherMeshBVH::FindNearestTriangle(const FVector3d& Point, double& OutDistanceSqr, const double MaxDistance) const
+{
+	int32 NearestTriangle = IndexConstants::InvalidID;
+	OutDistanceSqr = MaxDistance < TNumericLimits<double>::Max() ? MaxDistance * MaxDistance : TNumericLimits<double>::Max();
+	if (!IsValid())
+	{
+		return NearestTriangle;
+	}
+
+	TArray<TPair<int32, double>, TInlineAllocator<64>> Stack;
+	Stack.Add(TPair<int32, double>(0, Nodes[0].Box.DistanceSquared(Point)));
+
+	while (Stack.Num() > 0)
+	{
+		const TPair<int32, double> Entry = Stack.Pop(false);
+		if (Entry.Value > OutDistanceSqr)
+		{
+			continue;
+		}
+
+		const FNode& Node = Nodes[Entry.Key];
+		if (Node.IsLeaf())
+		{
+			for (int32 Slot = Node.TriangleStart; Slot < Node.TriangleStart + Node.TriangleCount; ++Slot)
+			{
+				const int32 TriangleID = Triangles[Slot];
+				FTriangle3d Triangle;
+				Mesh->GetTriVertices(TriangleID, Triangle.V[0], Triangle.V[1], Triangle.V[2]);
+				FDistPoint3Triangle3d Query(Point, Triangle);
+				const double DistanceSqr = Query.GetSquared();
+				if (DistanceSqr < OutDistanceSqr)
+				{
+					OutDistanceSqr = DistanceSqr;
+					NearestTriangle = TriangleID;
+				}
+			}
+		}
+		else
+		{
+			const double DistanceA = Nodes[Node.Child].Box.DistanceSquared(Point);
+			const double DistanceB = Nodes[Node.Child + 1].Box.DistanceSquared(Point);
+			const bool bAFirst = DistanceA <= DistanceB;
+			Stack.Add(bAFirst ? TPair<int32, double>(Node.Child + 1, DistanceB) : TPair<int32, double>(Node.Child, DistanceA));
+			Stack.Add(bAFirst ? TPair<int32, double>(Node.Child, DistanceA) : TPair<int32, double>(Node.Child + 1, DistanceB));
+		}
+	}
+	return NearestTriangle;
+}
@@ -20,6 +20,9 @@
 #include "InteractiveToolManager.h"
 
 #include "Components/MeshOctree.h"
+#include "Components/MeshMorpherMorphEvaluator.h"
+#include "Rendering/SkeletalMeshRenderData.h"
+#include "Spatial/PointHashGrid3.h"
 
 // default proxy for this component
 #include "Components/CustomMeshSceneProxy.h"
@@ -45,8 +48,12 @@ void UMeshMorpherMeshComponent::InitializeMesh(FMeshDescription* MeshDescription
 
 	Octree->RootDimension = Mesh->GetBounds().MaxDim() * 0.5;
 	Octree->Initialize(Mesh.Get());
+	MorphEvaluator->Reset();
+	InvalidateMirrorTable();
+	MeshBVH.Build(Mesh.Get());
+	bSpatialMeshCopied = false;
 	
-	SpatialData.SetMesh(Mesh.Get(), true);
+	SpatialData.Build(Mesh.Get());
 
 	SpatialNormals.SetMesh(Mesh.Get());
 	SpatialNormals.ComputeVertexNormals();
@@ -61,6 +68,10 @@ void UMeshMorpherMeshComponent::InitializeMesh(FDynamicMesh3* DynamicMesh)
 
 	Octree->RootDimension = Mesh->GetBounds().MaxDim() * 0.5;
 	Octree->Initialize(Mesh.Get());
+	MorphEvaluator->Reset();
+	InvalidateMirrorTable();
+	MeshBVH.Build(Mesh.Get());
+	bSpatialMeshCopied = false;
 	
 	NotifyMeshUpdated(TArray<int32>(), true);
 }
@@ -87,8 +98,13 @@ void UMeshMorpherMeshComponent::InitializeNewMesh()
 
 	Octree = MakeShareable(new FMeshMorpherMeshOctree());
 	Octree->Initialize(GetMesh());
+
+	MorphEvaluator = MakeShareable(new FMeshMorpherMorphEvaluator());
+	InvalidateMirrorTable();
+	MeshBVH.Build(Mesh.Get());
+	bSpatialMeshCopied = false;
 	
-	SpatialData.SetMesh(Mesh.Get(), true);
+	SpatialData.Build(Mesh.Get());
 
 	SpatialNormals.SetMesh(Mesh.Get());
 	SpatialNormals.ComputeVertexNormals();
@@ -134,6 +150,9 @@ void UMeshMorpherMeshComponent::CreateOrUpdateSelection()
 
 void UMeshMorpherMeshComponent::NotifyMeshUpdated(const TArray<int32>& VertArray, const bool bUpdateSpatialData)
 {
+	MarkSpatialDirty(VertArray);
+	//picking goes through the BVH with or without a render proxy
+	MeshBVH.Update(VertArray);
 	if (CurrentProxy != nullptr)
 	{
 		{
@@ -171,7 +190,14 @@ void UMeshMorpherMeshComponent::NotifyMeshUpdated(const TArray<int32>& VertArray
 				});
 			}
 			
-			UpdateNormals();
+			if(VertArray.Num() > 0)
+			{
+				UpdateRegionNormals(VertArray);
+			}
+			else
+			{
+				UpdateNormals();
+			}
 			Octree->ResetModifiedBounds();
 			CurrentProxy->CreateOrUpdateRenderData(TrianglesToUpdate);
 
@@ -183,14 +209,117 @@ void UMeshMorpherMeshComponent::NotifyMeshUpdated(const TArray<int32>& VertArray
 			}
 			if(bUpdateSpatialData)
 			{
-				SpatialMesh.Copy(*GetMesh(), false, false, false, false);
-				SpatialData.SetMesh(&SpatialMesh, true);
+				UpdateSpatialData(VertArray.Num() == 0);
+			}
+		}
+	}
+}
+
+void UMeshMorpherMeshComponent::MarkSpatialDirty(const TArray<int32>& VertArray)
+{
+	for (const int32 VertexID : VertArray)
+	{
+		if (VertexID < 0)
+		{
+			continue;
+		}
+
+		if (VertexID >= SpatialDirtyVertices.Num())
+		{
+			SpatialDirtyVertices.Add(false, VertexID + 1 - SpatialDirtyVertices.Num());
+		}
+
+		if (!SpatialDirtyVertices[VertexID])
+		{
+			SpatialDirtyVertices[VertexID] = true;
+			SpatialDirtyList.Add(VertexID);
+		}
+	}
+}
+
+void UMeshMorpherMeshComponent::UpdateSpatialData(const bool bFullCopy)
+{
+	const bool bCanRefit = !bFullCopy && bSpatialMeshCopied && SpatialData.GetMesh() == &SpatialMesh && SpatialTopologyChangeStamp == Mesh->GetTopologyChangeStamp() && SpatialMesh.MaxVertexID() == Mesh->MaxVertexID();
+
+	if (bCanRefit)
+	{
+		//same topology, only copy the vertices modified since the last refresh and refit around them
+		const int32 Count = SpatialDirtyList.Num();
+		if(Count > 0)
+		{
+			const int32 Cores = Count > FPlatformMisc::NumberOfCoresIncludingHyperthreads() ? FPlatformMisc::NumberOfCoresIncludingHyperthreads() : 1;
+			const int32 ChunkSize = FMath::FloorToInt((static_cast<double>(Count) / static_cast<double>(Cores)));
+			const int32 LastChunkSize = Count - (ChunkSize * Cores);
+			const int32 Chunks = LastChunkSize > 0 ? Cores + 1 : Cores;
+
+			ParallelFor(Chunks, [&](const int32 ChunkIndex)
+			{
+				const int32 IterationSize = ((LastChunkSize > 0) && (ChunkIndex == Chunks - 1)) ? LastChunkSize : ChunkSize;
+				for (int X = 0; X < IterationSize; ++X)
+				{
+					const int32 Index = (ChunkIndex * ChunkSize) + X;
+					const int32 VertexID = SpatialDirtyList[Index];
+					if (Mesh->IsVertex(VertexID))
+					{
+						SpatialMesh.SetVertex(VertexID, Mesh->GetVertex(VertexID), false);
+					}
+				}
+			});
+
+			SpatialData.Refit(SpatialDirtyList);
+			if (SpatialData.NeedsRebuild())
+			{
+				SpatialData.Build(&SpatialMesh);
+			}
 
-				SpatialNormals.SetMesh(&SpatialMesh);
-				SpatialNormals.ComputeVertexNormals();
+			//modified vertices plus their one ring
+			TArray<int32>& NormalIDs = ROIBuffers.NormalIDs;
+			NormalIDs.Reset();
+			const int32 VertexStamp = ROIBuffers.NextVertexStamp(SpatialMesh.MaxVertexID());
+			for (const int32 VertexID : SpatialDirtyList)
+			{
+				if (SpatialMesh.IsVertex(VertexID))
+				{
+					if (ROIBuffers.VertexStamps[VertexID] != VertexStamp)
+					{
+						ROIBuffers.VertexStamps[VertexID] = VertexStamp;
+						NormalIDs.Add(VertexID);
+					}
+					for (const int32 NeighbourID : SpatialMesh.VtxVerticesItr(VertexID))
+					{
+						if (ROIBuffers.VertexStamps[NeighbourID] != VertexStamp)
+						{
+							ROIBuffers.VertexStamps[NeighbourID] = VertexStamp;
+							NormalIDs.Add(NeighbourID);
+						}
+					}
+				}
 			}
+
+			TArray<FVector3d>& Normals = SpatialNormals.GetNormals();
+			ParallelFor(NormalIDs.Num(), [&](const int32 Index)
+			{
+				Normals[NormalIDs[Index]] = FMeshNormals::ComputeVertexNormal(SpatialMesh, NormalIDs[Index]);
+			});
 		}
 	}
+	else
+	{
+		SpatialMesh.Copy(*GetMesh(), false, false, false, false);
+		SpatialData.Build(&SpatialMesh);
+
+		SpatialNormals.SetMesh(&SpatialMesh);
+		SpatialNormals.ComputeVertexNormals();
+
+		SpatialTopologyChangeStamp = Mesh->GetTopologyChangeStamp();
+		bSpatialMeshCopied = true;
+	}
+
+	for (const int32 VertexID : SpatialDirtyList)
+	{
+		SpatialDirtyVertices[VertexID] = false;
+	}
+	SpatialDirtyList.Reset();
 }
 
 FPrimitiveSceneProxy* UMeshMorpherMeshComponent::CreateSceneProxy()
@@ -390,6 +519,72 @@ void UMeshMorpherMeshComponent::GetTriangleROI2(const TSet<int32>& VertexROI, TS
 	}
 }
 
+void UMeshMorpherMeshComponent::GetTriangleROIArray(const TArray<int32>& VertexROI, TArray<int32>& TriangleROI) const
+{
+	TriangleROI.Reset();
+
+	const int32 NumVerts = VertexROI.Num();
+	if(NumVerts > 0)
+	{
+		const int32 Cores = NumVerts > FPlatformMisc::NumberOfCoresIncludingHyperthreads() ? FPlatformMisc::NumberOfCoresIncludingHyperthreads() : 1;
+		const int32 ChunkSize = FMath::FloorToInt((static_cast<double>(NumVerts) / static_cast<double>(Cores)));
+		const int32 LastChunkSize = NumVerts - (ChunkSize * Cores);
+		const int32 Chunks = LastChunkSize > 0 ? Cores + 1 : Cores;
+
+		const int32 Stamp = ROIBuffers.NextTriangleStamp(Mesh->MaxTriangleID());
+		int32* TriangleStamps = ROIBuffers.TriangleStamps.GetData();
+		if (ROIBuffers.ChunkTriangles.Num() < Chunks)
+		{
+			ROIBuffers.ChunkTriangles.SetNum(Chunks);
+		}
+
+		ParallelFor(Chunks, [&](const int32 ChunkIndex)
+		{
+			TArray<int32>& LocalTriangleROI = ROIBuffers.ChunkTriangles[ChunkIndex];
+			LocalTriangleROI.Reset();
+			const int32 IterationSize = ((LastChunkSize > 0) && (ChunkIndex == Chunks - 1)) ? LastChunkSize : ChunkSize;
+			for (int X = 0; X < IterationSize; ++X)
+			{
+				const int32 Index = (ChunkIndex * ChunkSize) + X;
+				const int32 vid = VertexROI[Index];
+
+				if(SelectedVertices.Contains(vid) && MaskingBehaviour == EMaskingBehaviour::HIDESELECTED)
+				{
+					continue;
+				}
+			
+				if(!SelectedVertices.Contains(vid) && MaskingBehaviour == EMaskingBehaviour::HIDEUNSELECTED)
+				{
+					continue;
+				}
+
+				for (const int32 tid : Mesh->VtxTrianglesItr(vid))
+				{
+					if (TriangleStamps[tid] == Stamp)
+					{
+						continue;
+					}
+
+					if((SelectedTriangles.Contains(tid) && MaskingBehaviour == EMaskingBehaviour::HIDESELECTED) || (!SelectedTriangles.Contains(tid) && MaskingBehaviour == EMaskingBehaviour::HIDEUNSELECTED))
+					{
+						continue;
+					}
+
+					if (FPlatformAtomics::InterlockedExchange(&TriangleStamps[tid], Stamp) != Stamp)
+					{
+						LocalTriangleROI.Add(tid);
+					}
+				}
+			}
+		});
+
+		for (int32 ChunkIndex = 0; ChunkIndex < Chunks; ++ChunkIndex)
+		{
+			TriangleROI.Append(ROIBuffers.ChunkTriangles[ChunkIndex]);
+		}
+	}
+}
+
 void UMeshMorpherMeshComponent::GetSelectedFromSections(const TArray<int32>& Sections, TSet<int32>& OutSelectedVertices, TSet<int32>& OutSelectedTriangles) const
 {
 	const FDynamicMeshMaterialAttribute* MaterialID = nullptr;
@@ -444,9 +639,36 @@ FBoxSphereBounds UMeshMorpherMeshComponent::CalcBounds(const FTransform& LocalTo
 {
 	// Bounds are tighter if the box is generated from pre-transformed vertices.
 	FBox BoundingBox(ForceInit);
-	for (FVector3d Vertex : Mesh->VerticesItr())
+	const int32 MaxVertexID = Mesh->MaxVertexID();
+	if (MaxVertexID > 0)
 	{
-		BoundingBox += LocalToWorld.TransformPosition(Vertex);
+		const int32 Cores = MaxVertexID > FPlatformMisc::NumberOfCoresIncludingHyperthreads() ? FPlatformMisc::NumberOfCoresIncludingHyperthreads() : 1;
+		const int32 ChunkSize = FMath::FloorToInt((static_cast<double>(MaxVertexID) / static_cast<double>(Cores)));
+		const int32 LastChunkSize = MaxVertexID - (ChunkSize * Cores);
+		const int32 Chunks = LastChunkSize > 0 ? Cores + 1 : Cores;
+
+		//One box per chunk, reduced serially afterwards
+		TArray<FBox> ChunkBoxes;
+		ChunkBoxes.Init(FBox(ForceInit), Chunks);
+
+		ParallelFor(Chunks, [&](const int32 ChunkIndex)
+		{
+			FBox& ChunkBox = ChunkBoxes[ChunkIndex];
+			const int32 IterationSize = ((LastChunkSize > 0) && (ChunkIndex == Chunks - 1)) ? LastChunkSize : ChunkSize;
+			for (int X = 0; X < IterationSize; ++X)
+			{
+				const int32 VertexID = (ChunkIndex * ChunkSize) + X;
+				if (Mesh->IsVertex(VertexID))
+				{
+					ChunkBox += LocalToWorld.TransformPosition(Mesh->GetVertex(VertexID));
+				}
+			}
+		});
+
+		for (const FBox& ChunkBox : ChunkBoxes)
+		{
+			BoundingBox += ChunkBox;
+		}
 	}
 
 	FBoxSphereBounds NewBounds;
@@ -471,6 +693,96 @@ void UMeshMorpherMeshComponent::ApplyChanges(const TArray<int32>& VertArray1, co
 	}
 }
 
+bool UMeshMorpherMeshComponent::InitializeMorphTargets(USkeletalMesh* SkeletalMesh, const int32 LOD)
+{
+	MorphEvaluator->Reset();
+	if (SkeletalMesh)
+	{
+		//Morph target deltas index the base vertices of the LOD, the internal mesh has to use the same vertex IDs
+		TArray<FName> MorphNames;
+		TArray<TArray<FMorphTargetDelta>> MorphDeltas;
+		int32 NumBaseMeshVerts = 0;
+		int32 NumSourceVerts = 0;
+		for (UMorphTarget* MorphTarget : SkeletalMesh->GetMorphTargets())
+		{
+			if (MorphTarget && MorphTarget->HasDataForLOD(LOD))
+			{
+				const FMorphTargetLODModel& MorphModel = MorphTarget->GetMorphLODModels()[LOD];
+				NumBaseMeshVerts = FMath::Max(NumBaseMeshVerts, MorphModel.NumBaseMeshVerts);
+				for (const FMorphTargetDelta& Delta : MorphModel.Vertices)
+				{
+					NumSourceVerts = FMath::Max(NumSourceVerts, static_cast<int32>(Delta.SourceIdx) + 1);
+				}
+				MorphNames.Add(MorphTarget->GetFName());
+				MorphDeltas.Add(MorphModel.Vertices);
+			}
+		}
+
+		//Render data is only a fallback, it does not exist on dedicated servers
+		int32 ExpectedVertexCount = NumBaseMeshVerts;
+		if (ExpectedVertexCount <= 0)
+		{
+			const FSkeletalMeshRenderData* Resource = SkeletalMesh->GetResourceForRendering();
+			if (Resource && Resource->LODRenderData.IsValidIndex(LOD))
+			{
+				ExpectedVertexCount = static_cast<int32>(Resource->LODRenderData[LOD].GetNumVertices());
+			}
+		}
+
+		if (!Mesh->IsCompactV() || NumSourceVerts > Mesh->MaxVertexID() || (ExpectedVertexCount > 0 && Mesh->MaxVertexID() != ExpectedVertexCount))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("%s LOD %d morph targets need %d vertices (deltas up to %d) but the mesh has %d vertices (max ID %d), morph targets not captured."), *SkeletalMesh->GetName(), LOD, ExpectedVertexCount, NumSourceVerts, Mesh->VertexCount(), Mesh->MaxVertexID());
+			return false;
+		}
+
+		if (MorphNames.Num() > 0)
+		{
+			MorphEvaluator->Initialize(*Mesh, MorphNames, MorphDeltas);
+		}
+	}
+	return MorphEvaluator->NumMorphs() > 0;
+}
+
+bool UMeshMorpherMeshComponent::EvaluateMorphTargets(const TMap<FName, float>& Weights)
+{
+	if (!MorphEvaluator->IsInitialized())
+	{
+		return false;
+	}
+
+	MorphEvaluator->ClearWeights();
+	MorphEvaluator->SetWeights(Weights);
+	MorphEvaluator->Evaluate(*Mesh);
+
+	if (CurrentProxy != nullptr)
+	{
+		NotifyMeshUpdated(MorphEvaluator->GetAffectedVertices());
+	}
+	else
+	{
+		//No render proxy yet, keep the octree in sync so queries stay valid
+		Octree->ReinsertTriangles(MorphEvaluator->GetAffectedTriangles());
+		Octree->ResetModifiedBounds();
+		MeshBVH.Update(MorphEvaluator->GetAffectedVertices());
+		MarkSpatialDirty(MorphEvaluator->GetAffectedVertices());
+		UpdateBounds();
+	}
+	return true;
+}
+
+bool UMeshMorpherMeshComponent::EvaluateMorphTargetPositions(const TMap<FName, float>& Weights, TArray<FVector3f>& OutPositions)
+{
+	if (!MorphEvaluator->IsInitialized())
+	{
+		return false;
+	}
+
+	MorphEvaluator->ClearWeights();
+	MorphEvaluator->SetWeights(Weights);
+	MorphEvaluator->Evaluate(OutPositions);
+	return true;
+}
+
 void UMeshMorpherMeshComponent::ApplyChange(const FMeshVertexChange* Change, const bool bRevert)
 {
 	const int32 NV = Change->Vertices.Num();
@@ -1231,6 +1543,104 @@ void UMeshMorpherMeshComponent::ComputeVertexNormal(const int32 VertexID, const
 	Normal = SumNormal.GetSafeNormal();
 }
 
+int32 UMeshMorpherMeshComponent::BuildMirrorTable(const FVector& PlaneOrigin, const FVector& PlaneNormal, const double Tolerance)
+{
+	InvalidateMirrorTable();
+
+	const FVector3d Origin(PlaneOrigin);
+	const FVector3d Normal = FVector3d(PlaneNormal).GetSafeNormal();
+	const int32 MaxVertexID = Mesh->MaxVertexID();
+	if (MaxVertexID <= 0 || Normal.IsZero())
+	{
+		return 0;
+	}
+
+	const double SearchRadius = FMath::Max(Tolerance, static_cast<double>(KINDA_SMALL_NUMBER));
+	TPointHashGrid3d<int32> Grid(SearchRadius, INDEX_NONE);
+	for (const int32 VertexID : Mesh->VertexIndicesItr())
+	{
+		Grid.InsertPointUnsafe(VertexID, Mesh->GetVertex(VertexID));
+	}
+
+	MirrorTable.MirrorVertices.Init(INDEX_NONE, MaxVertexID);
+	TAtomic<int32> Matched(0);
+
+	const int32 Cores = MaxVertexID > FPlatformMisc::NumberOfCoresIncludingHyperthreads() ? FPlatformMisc::NumberOfCoresIncludingHyperthreads() : 1;
+	const int32 ChunkSize = FMath::FloorToInt((static_cast<double>(MaxVertexID) / static_cast<double>(Cores)));
+	const int32 LastChunkSize = MaxVertexID - (ChunkSize * Cores);
+	const int32 Chunks = LastChunkSize > 0 ? Cores + 1 : Cores;
+
+	ParallelFor(Chunks, [&](const int32 ChunkIndex)
+	{
+		int32 LocalMatched = 0;
+		const int32 IterationSize = ((LastChunkSize > 0) && (ChunkIndex == Chunks - 1)) ? LastChunkSize : ChunkSize;
+		for (int X = 0; X < IterationSize; ++X)
+		{
+			const int32 VertexID = (ChunkIndex * ChunkSize) + X;
+			if (Mesh->IsVertex(VertexID))
+			{
+				const FVector3d Position = Mesh->GetVertex(VertexID);
+				const FVector3d Mirrored = Position - 2.0 * (Position - Origin).Dot(Normal) * Normal;
+				const TPair<int32, double> Closest = Grid.FindNearestInRadius(Mirrored, SearchRadius, [&](const int32& Other)
+				{
+					return FVector3d::DistSquared(Mesh->GetVertex(Other), Mirrored);
+				});
+
+				if (Closest.Key != INDEX_NONE)
+				{
+					MirrorTable.MirrorVertices[VertexID] = Closest.Key;
+					LocalMatched++;
+				}
+			}
+		}
+		Matched += LocalMatched;
+	});
+
+	MirrorTable.PlaneOrigin = Origin;
+	MirrorTable.PlaneNormal = Normal;
+	MirrorTable.Tolerance = Tolerance;
+	MirrorTable.TopologyChangeStamp = Mesh->GetTopologyChangeStamp();
+	MirrorTable.MaxVertexID = MaxVertexID;
+	MirrorTable.bBuilt = true;
+	return Matched;
+}
+
+void UMeshMorpherMeshComponent::InvalidateMirrorTable()
+{
+	MirrorTable.MirrorVertices.Empty();
+	MirrorTable.bBuilt = false;
+}
+
+bool UMeshMorpherMeshComponent::HasValidMirrorTable() const
+{
+	return MirrorTable.bBuilt && MirrorTable.MaxVertexID == Mesh->MaxVertexID() && MirrorTable.TopologyChangeStamp == Mesh->GetTopologyChangeStamp();
+}
+
+int32 UMeshMorpherMeshComponent::GetMirrorVertex(const int32 VertexID) const
+{
+	if (HasValidMirrorTable() && MirrorTable.MirrorVertices.IsValidIndex(VertexID))
+	{
+		return MirrorTable.MirrorVertices[VertexID];
+	}
+	return INDEX_NONE;
+}
+
+void UMeshMorpherMeshComponent::GetMirrorVertices(const TArray<int32>& VertexIDs, TArray<int32>& OutMirrorVertices) const
+{
+	OutMirrorVertices.Reset();
+	if (HasValidMirrorTable())
+	{
+		OutMirrorVertices.Reserve(VertexIDs.Num());
+		for (const int32 VertexID : VertexIDs)
+		{
+			if (MirrorTable.MirrorVertices.IsValidIndex(VertexID) && MirrorTable.MirrorVertices[VertexID] != INDEX_NONE)
+			{
+				OutMirrorVertices.Add(MirrorTable.MirrorVertices[VertexID]);
+			}
+		}
+	}
+}
+
 bool UMeshMorpherMeshComponent::GetBrushPositionOnMesh(const FVector& RayOrigin, const FVector& RayDirection, const FVector& EyePosition, const bool bHitBackFaces, const bool bNeedsSymmetry, const FVector SymmetryAxis, FBrushPosition& BrushPosition, FBrushPosition& SymmetricBrushPosition) const
 {
 	const FVector Origin = GetComponentTransform().InverseTransformPosition(RayOrigin);
@@ -1437,20 +1847,18 @@ bool UMeshMorpherMeshComponent::HitTest(const FVector& RayOrigin, const FVector&
 
 void UMeshMorpherMeshComponent::GetVertexROIAtLocationInRadius(const FVector& EyePosition, const FVector& BrushPos, const double& BrushSize, const bool bOnlyFacingCamera, TArray<int32>& ROI, TArray<int32>& TriangleROI, FVector& AverageNormal) const
 {
-	ROI.Empty();
-	TriangleROI.Empty();
+	//Reset instead of Empty, callers reuse these arrays every tick
+	ROI.Reset();
+	TriangleROI.Reset();
 	AverageNormal = FVector::ZeroVector;
 	const double RadiusSqr = (BrushSize * BrushSize);
 
 	const FVector3d LocalBrushPos = FVector3d(GetComponentTransform().InverseTransformPosition(BrushPos));
 	const FVector LocalEyePosition(GetComponentTransform().InverseTransformPosition(EyePosition));
-	const FAxisAlignedBox3d BrushBox(LocalBrushPos - BrushSize * FVector3d::One(), LocalBrushPos + BrushSize * FVector3d::One());
 
-	TSet<int32> VertexSetBuffer;
-	VertexSetBuffer.Reset();
 	FVector AvgNormal = FVector::ZeroVector;
 
-	Octree->ParallelRangeQueryArray(BrushBox, TriangleROI, bOnlyFacingCamera, LocalEyePosition, SelectedTriangles, MaskingBehaviour);
+	Octree->ParallelSphereQueryArray(LocalBrushPos, BrushSize, TriangleROI, ROIBuffers.BranchTriangles, bOnlyFacingCamera, LocalEyePosition, SelectedTriangles, MaskingBehaviour);
 
 	const int32 Count = TriangleROI.Num();
 	if(Count > 0)
@@ -1461,10 +1869,19 @@ void UMeshMorpherMeshComponent::GetVertexROIAtLocationInRadius(const FVector& Ey
 		const int32 LastChunkSize = Count - (ChunkSize * Cores);
 		const int32 Chunks = LastChunkSize > 0 ? Cores + 1 : Cores;
 
+		//Vertices shared by several triangles are claimed once through the stamp buffer
+		const int32 Stamp = ROIBuffers.NextVertexStamp(Mesh->MaxVertexID());
+		int32* VertexStamps = ROIBuffers.VertexStamps.GetData();
+		if (ROIBuffers.ChunkVertices.Num() < Chunks)
+		{
+			ROIBuffers.ChunkVertices.SetNum(Chunks);
+		}
+
 		ParallelFor(Chunks, [&](const int32 ChunkIndex)
 		{
-			TSet<int32> LocalVertices;
-			FVector LocalAvgNormal;
+			TArray<int32>& LocalVertices = ROIBuffers.ChunkVertices[ChunkIndex];
+			LocalVertices.Reset();
+			FVector LocalAvgNormal = FVector::ZeroVector;
 			
 			const int32 IterationSize = ((LastChunkSize > 0) && (ChunkIndex == Chunks - 1)) ? LastChunkSize : ChunkSize;
 			for (int X = 0; X < IterationSize; ++X)
@@ -1481,6 +1898,11 @@ void UMeshMorpherMeshComponent::GetVertexROIAtLocationInRadius(const FVector& Ey
 
 				for (int32 j = 0; j < 3; ++j)
 				{
+					if (VertexStamps[TriV[j]] == Stamp)
+					{
+						continue;
+					}
+
 					if(SelectedVertices.Contains(TriV[j]) && MaskingBehaviour == EMaskingBehaviour::HIDESELECTED)
 					{
 						continue;
@@ -1494,22 +1916,26 @@ void UMeshMorpherMeshComponent::GetVertexROIAtLocationInRadius(const FVector& Ey
 					FVector3d Position = Mesh->GetVertex(TriV[j]);
 					if ((Position - LocalBrushPos).SquaredLength() < RadiusSqr)
 					{
-						LocalVertices.Add(TriV[j]);
+						if (FPlatformAtomics::InterlockedExchange(&VertexStamps[TriV[j]], Stamp) != Stamp)
+						{
+							LocalVertices.Add(TriV[j]);
+						}
 					}
 				}
 			}
 
 			Lock.Lock();
-			VertexSetBuffer.Append(LocalVertices);
 			AvgNormal += LocalAvgNormal;
 			Lock.Unlock();
 		});
 		AverageNormal = AvgNormal / TriangleROI.Num();
 		AverageNormal.Normalize();
-	}
 
-	ROI.SetNum(0, false);
-	BufferUtil::AppendElements(ROI, VertexSetBuffer);
+		for (int32 ChunkIndex = 0; ChunkIndex < Chunks; ++ChunkIndex)
+		{
+			ROI.Append(ROIBuffers.ChunkVertices[ChunkIndex]);
+		}
+	}
 }
 
 void UMeshMorpherMeshComponent::ComputeROIBrushPlane(const TArray<int32>& TriangleROI, const FVector& BrushCenter, const double BrushSize, const double FalloffAmount, const double Depth, const bool bIgnoreDepth, FVector& PlaneOrigin, FVector& PlaneNormal) const
@@ -1575,45 +2001,38 @@ void UMeshMorpherMeshComponent::ComputeROIBrushPlane(const TArray<int32>& Triang
 int32 UMeshMorpherMeshComponent::FindHitSpatialMeshTriangle(const FVector& RayOrigin, const FVector& RayDirection, const FVector& EyePosition, const bool bHitBackFaces) const
 {
 	const UE::Geometry::TRay<double>& Ray = FRay(RayOrigin, RayDirection);
+	const FVector LocalEyePosition(GetComponentTransform().InverseTransformPosition(EyePosition));
 
-	if (!bHitBackFaces)
+	auto TriangleFilter = [this, bHitBackFaces, &LocalEyePosition](const int32 TriangleID)
 	{
-		return Octree->FindNearestHitObject(Ray, [this](const int32 TriangleID)
+		if(SelectedTriangles.Contains(TriangleID) && MaskingBehaviour == EMaskingBehaviour::HIDESELECTED)
 		{
-			if(SelectedTriangles.Contains(TriangleID) && MaskingBehaviour == EMaskingBehaviour::HIDESELECTED)
-			{
-				return false;
-			}
+			return false;
+		}
 
-			if(!SelectedTriangles.Contains(TriangleID) && MaskingBehaviour == EMaskingBehaviour::HIDEUNSELECTED)
-			{
-				return false;
-			}
+		if(!SelectedTriangles.Contains(TriangleID) && MaskingBehaviour == EMaskingBehaviour::HIDEUNSELECTED)
+		{
+			return false;
+		}
 
-			return true;
-		});
-	}
-	else
-	{
-		FVector LocalEyePosition(GetComponentTransform().InverseTransformPosition(EyePosition));
-		const int32 HitTID = Octree->FindNearestHitObject(Ray, [this, &LocalEyePosition](const int32 TriangleID)
+		if (!bHitBackFaces)
 		{
-			if(SelectedTriangles.Contains(TriangleID) && MaskingBehaviour == EMaskingBehaviour::HIDESELECTED)
-			{
-				return false;
-			}
+			return true;
+		}
 
-			if(!SelectedTriangles.Contains(TriangleID) && MaskingBehaviour == EMaskingBehaviour::HIDEUNSELECTED)
-			{
-				return false;
-			}
-			FVector Normal, Centroid;
-			double Area;
-			GetTriInfo(TriangleID, Normal, Area, Centroid);
-			return FVector::DotProduct(Normal, (Centroid - LocalEyePosition)) < 0.0;
-		});
-		return HitTID;
+		FVector Normal, Centroid;
+		double Area;
+		GetTriInfo(TriangleID, Normal, Area, Centroid);
+		return FVector::DotProduct(Normal, (Centroid - LocalEyePosition)) < 0.0;
+	};
+
+	//a topology change without NotifyMeshUpdated leaves the BVH stale, fall back to the octree until the next update
+	if (MeshBVH.IsValid() && MeshBVH.GetMesh() == Mesh.Get() && !MeshBVH.NeedsRebuild())
+	{
+		double HitDistance;
+		return MeshBVH.FindNearestHitTriangle(Ray, HitDistance, TriangleFilter);
 	}
+	return Octree->FindNearestHitObject(Ray, TriangleFilter);
 }
 
 void UMeshMorpherMeshComponent::RecalculateNormals_PerVertex()
@@ -1698,6 +2117,101 @@ void UMeshMorpherMeshComponent::UpdateNormals()
 	}
 }
 
+void UMeshMorpherMeshComponent::UpdateRegionNormals(const TArray<int32>& ModifiedVertices)
+{
+	FDynamicMeshNormalOverlay* Normals = Mesh->HasAttributes() ? Mesh->Attributes()->PrimaryNormals() : nullptr;
+	if (ModifiedVertices.Num() == 0 || (!Normals && !Mesh->HasVertexNormals()))
+	{
+		return;
+	}
+
+	//every triangle around a modified vertex, its corners are the modified vertices plus their one ring
+	TArray<int32>& Triangles = ROIBuffers.NormalTriangles;
+	Triangles.Reset();
+	const int32 TriangleStamp = ROIBuffers.NextTriangleStamp(Mesh->MaxTriangleID());
+	for (const int32 VertexID : ModifiedVertices)
+	{
+		if (Mesh->IsVertex(VertexID))
+		{
+			for (const int32 TriangleID : Mesh->VtxTrianglesItr(VertexID))
+			{
+				if (ROIBuffers.TriangleStamps[TriangleID] != TriangleStamp)
+				{
+					ROIBuffers.TriangleStamps[TriangleID] = TriangleStamp;
+					Triangles.Add(TriangleID);
+				}
+			}
+		}
+	}
+
+	//unique overlay elements or vertices of those triangles
+	TArray<int32>& NormalIDs = ROIBuffers.NormalIDs;
+	NormalIDs.Reset();
+	if (Normals)
+	{
+		const int32 ElementStamp = ROIBuffers.NextElementStamp(Normals->MaxElementID());
+		for (const int32 TriangleID : Triangles)
+		{
+			if (Normals->IsSetTriangle(TriangleID))
+			{
+				const FIndex3i TriElems = Normals->GetTriangle(TriangleID);
+				for (int32 j = 0; j < 3; ++j)
+				{
+					if (ROIBuffers.ElementStamps[TriElems[j]] != ElementStamp)
+					{
+						ROIBuffers.ElementStamps[TriElems[j]] = ElementStamp;
+						NormalIDs.Add(TriElems[j]);
+					}
+				}
+			}
+		}
+	}
+	else
+	{
+		const int32 VertexStamp = ROIBuffers.NextVertexStamp(Mesh->MaxVertexID());
+		for (const int32 TriangleID : Triangles)
+		{
+			const FIndex3i TriVerts = Mesh->GetTriangle(TriangleID);
+			for (int32 j = 0; j < 3; ++j)
+			{
+				if (ROIBuffers.VertexStamps[TriVerts[j]] != VertexStamp)
+				{
+					ROIBuffers.VertexStamps[TriVerts[j]] = VertexStamp;
+					NormalIDs.Add(TriVerts[j]);
+				}
+			}
+		}
+	}
+
+	const int32 Count = NormalIDs.Num();
+	if(Count > 0)
+	{
+		const int32 Cores = Count > FPlatformMisc::NumberOfCoresIncludingHyperthreads() ? FPlatformMisc::NumberOfCoresIncludingHyperthreads() : 1;
+		const int32 ChunkSize = FMath::FloorToInt((static_cast<double>(Count) / static_cast<double>(Cores)));
+		const int32 LastChunkSize = Count - (ChunkSize * Cores);
+		const int32 Chunks = LastChunkSize > 0 ? Cores + 1 : Cores;
+
+		ParallelFor(Chunks, [&](const int32 ChunkIndex)
+		{
+			const int32 IterationSize = ((LastChunkSize > 0) && (ChunkIndex == Chunks - 1)) ? LastChunkSize : ChunkSize;
+			for (int X = 0; X < IterationSize; ++X)
+			{
+				const int32 Index = (ChunkIndex * ChunkSize) + X;
+				if (Normals)
+				{
+					const FVector3d NewNormal = FMeshNormals::ComputeOverlayNormal(*Mesh.Get(), Normals, NormalIDs[Index]);
+					Normals->SetElement(NormalIDs[Index], static_cast<FVector3f>(NewNormal));
+				}
+				else
+				{
+					const FVector3d NewNormal = FMeshNormals::ComputeVertexNormal(*Mesh.Get(), NormalIDs[Index]);
+					Mesh->SetVertexNormal(NormalIDs[Index], static_cast<FVector3f>(NewNormal));
+				}
+			}
+		});
+	}
+}
+
 double UMeshMorpherMeshComponent::BrushSizeToBrushRadius(const double BrushSize)
 {
 	const double MaxDimension = GetMesh()->GetBounds().MaxDim();
@@ -1707,32 +2221,78 @@ double UMeshMorpherMeshComponent::BrushSizeToBrushRadius(const double BrushSize)
 
 void UMeshMorpherMeshComponent::BeginChange()
 {
-	if (!ActiveVertexChange.IsValid())
+	if (!ActiveStroke.bActive)
 	{
-		ActiveVertexChange = MakeShareable(new FMeshVertexChangeBuilder());
+		ActiveStroke.Begin(Mesh->MaxVertexID());
 	}
 }
 
 
 void UMeshMorpherMeshComponent::EndChange()
 {
-	if (ActiveVertexChange.IsValid())
+	if (ActiveStroke.bActive)
 	{
+		ActiveStroke.bActive = false;
+
 		UMeshSurfacePointTool* Tool = Cast<UMeshSurfacePointTool>(GetOuter());
-		if (Tool)
+		const int32 NV = ActiveStroke.Vertices.Num();
+		if (Tool && NV > 0)
 		{
-			Tool->GetToolManager()->EmitObjectChange(this, MoveTemp(ActiveVertexChange->Change), FText::FromString("Brush Stroke"));
+			TUniquePtr<FMeshVertexChange> Change = MakeUnique<FMeshVertexChange>();
+
+			const int32 Cores = NV > FPlatformMisc::NumberOfCoresIncludingHyperthreads() ? FPlatformMisc::NumberOfCoresIncludingHyperthreads() : 1;
+			const int32 ChunkSize = FMath::FloorToInt((static_cast<double>(NV) / static_cast<double>(Cores)));
+			const int32 LastChunkSize = NV - (ChunkSize * Cores);
+			const int32 Chunks = LastChunkSize > 0 ? Cores + 1 : Cores;
 
+			ParallelFor(Chunks, [&](const int32 ChunkIndex)
+			{
+				const int32 IterationSize = ((LastChunkSize > 0) && (ChunkIndex == Chunks - 1)) ? LastChunkSize : ChunkSize;
+				for (int X = 0; X < IterationSize; ++X)
+				{
+					const int32 Index = (ChunkIndex * ChunkSize) + X;
+					const int32 VertexID = ActiveStroke.Vertices[Index];
+					if (!ActiveStroke.ExplicitNewPositions[Index] && Mesh->IsVertex(VertexID))
+					{
+						ActiveStroke.NewPositions[Index] = Mesh->GetVertex(VertexID);
+					}
+				}
+			});
+
+			Change->Vertices = MoveTemp(ActiveStroke.Vertices);
+			Change->OldPositions = MoveTemp(ActiveStroke.OldPositions);
+			Change->NewPositions = MoveTemp(ActiveStroke.NewPositions);
+
+			Tool->GetToolManager()->EmitObjectChange(this, MoveTemp(Change), FText::FromString("Brush Stroke"));
 		}
-		ActiveVertexChange.Reset();
+		ActiveStroke.Vertices.Reset();
+		ActiveStroke.OldPositions.Reset();
+		ActiveStroke.NewPositions.Reset();
+		ActiveStroke.ExplicitNewPositions.Reset();
 	}
 }
 
 void UMeshMorpherMeshComponent::UpdateSavedVertex(const int32 VertexID, const FVector& OldPosition, const FVector& NewPosition)
 {
-	if (ActiveVertexChange.IsValid())
+	if (ActiveStroke.bActive && VertexID >= 0)
+	{
+		//the first call keeps the old position, the last one sets the new position
+		const int32 Slot = ActiveStroke.SaveVertex(VertexID, OldPosition);
+		ActiveStroke.SetNewPosition(Slot, FVector3d(NewPosition));
+	}
+}
+
+void UMeshMorpherMeshComponent::UpdateSavedVertices(const TArray<int32>& VertexIDs)
+{
+	if (ActiveStroke.bActive)
 	{
-		ActiveVertexChange->UpdateVertex(VertexID, OldPosition, NewPosition);
+		for (const int32 VertexID : VertexIDs)
+		{
+			if (Mesh->IsVertex(VertexID))
+			{
+				ActiveStroke.SaveVertex(VertexID, Mesh->GetVertex(VertexID));
+			}
+		}
 	}
 }
 
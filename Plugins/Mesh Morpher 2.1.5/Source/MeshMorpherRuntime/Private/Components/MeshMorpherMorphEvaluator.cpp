@@ -0,0 +1,180 @@
+// Copyright 2020-2022 SC Pug Life Studio S.R.L. All Rights Reserved.
+#include "Components/MeshMorpherMorphEvaluator.h"
+#include "Async/ParallelFor.h"
+
+void FMeshMorpherMorphEvaluator::Initialize(const FDynamicMesh3& BaseMesh, const TArray<FName>& InMorphNames, const TArray<TArray<FMorphTargetDelta>>& InMorphDeltas)
+{
+	Reset();
+
+	const int32 MaxVertexID = BaseMesh.MaxVertexID();
+	BasePositions.SetNumZeroed(MaxVertexID);
+	for (const int32 VertexID : BaseMesh.VertexIndicesItr())
+	{
+		BasePositions[VertexID] = BaseMesh.GetVertex(VertexID);
+	}
+
+	const int32 MorphCount = FMath::Min(InMorphNames.Num(), InMorphDeltas.Num());
+	MorphNames.Append(InMorphNames.GetData(), MorphCount);
+	for (int32 MorphIndex = 0; MorphIndex < MorphCount; ++MorphIndex)
+	{
+		MorphIndices.Add(MorphNames[MorphIndex], MorphIndex);
+	}
+	Weights.SetNumZeroed(MorphCount);
+
+	TArray<int32> DeltaCounts;
+	DeltaCounts.SetNumZeroed(MaxVertexID);
+	for (int32 MorphIndex = 0; MorphIndex < MorphCount; ++MorphIndex)
+	{
+		for (const FMorphTargetDelta& Delta : InMorphDeltas[MorphIndex])
+		{
+			if (BaseMesh.IsVertex(static_cast<int32>(Delta.SourceIdx)))
+			{
+				DeltaCounts[Delta.SourceIdx]++;
+			}
+		}
+	}
+
+	TArray<int32> VertexRows;
+	VertexRows.Init(INDEX_NONE, MaxVertexID);
+	RowOffsets.Add(0);
+	for (int32 VertexID = 0; VertexID < MaxVertexID; ++VertexID)
+	{
+		if (DeltaCounts[VertexID] > 0)
+		{
+			VertexRows[VertexID] = AffectedVertices.Add(VertexID);
+			RowOffsets.Add(RowOffsets.Last() + DeltaCounts[VertexID]);
+		}
+	}
+
+	RowMorphIndices.SetNumUninitialized(RowOffsets.Last());
+	RowDeltas.SetNumUninitialized(RowOffsets.Last());
+
+	TArray<int32> RowCursors(RowOffsets.GetData(), AffectedVertices.Num());
+	for (int32 MorphIndex = 0; MorphIndex < MorphCount; ++MorphIndex)
+	{
+		for (const FMorphTargetDelta& Delta : InMorphDeltas[MorphIndex])
+		{
+			if (BaseMesh.IsVertex(static_cast<int32>(Delta.SourceIdx)))
+			{
+				const int32 Slot = RowCursors[VertexRows[Delta.SourceIdx]]++;
+				RowMorphIndices[Slot] = MorphIndex;
+				RowDeltas[Slot] = Delta.PositionDelta;
+			}
+		}
+	}
+
+	for (const int32 TriangleID : BaseMesh.TriangleIndicesItr())
+	{
+		const FIndex3i Triangle = BaseMesh.GetTriangle(TriangleID);
+		if (VertexRows[Triangle.A] != INDEX_NONE || VertexRows[Triangle.B] != INDEX_NONE || VertexRows[Triangle.C] != INDEX_NONE)
+		{
+			AffectedTriangles.Add(TriangleID);
+		}
+	}
+}
+
+void FMeshMorpherMorphEvaluator::Reset()
+{
+	MorphNames.Empty();
+	MorphIndices.Empty();
+	Weights.Empty();
+	BasePositions.Empty();
+	AffectedVertices.Empty();
+	RowOffsets.Empty();
+	RowMorphIndices.Empty();
+	RowDeltas.Empty();
+	AffectedTriangles.Empty();
+}
+
+int32 FMeshMorpherMorphEvaluator::FindMorphIndex(const FName& MorphName) const
+{
+	const int32* MorphIndex = MorphIndices.Find(MorphName);
+	return MorphIndex ? *MorphIndex : INDEX_NONE;
+}
+
+void FMeshMorpherMorphEvaluator::ClearWeights()
+{
+	for (float& Weight : Weights)
+	{
+		Weight = 0.0f;
+	}
+}
+
+void FMeshMorpherMorphEvaluator::SetWeight(const int32 MorphIndex, const float Weight)
+{
+	if (Weights.IsValidIndex(MorphIndex))
+	{
+		Weights[MorphIndex] = Weight;
+	}
+}
+
+void FMeshMorpherMorphEvaluator::SetWeights(const TMap<FName, float>& InWeights)
+{
+	for (const TPair<FName, float>& Weight : InWeights)
+	{
+		SetWeight(FindMorphIndex(Weight.Key), Weight.Value);
+	}
+}
+
+template<typename WriteFunc>
+void FMeshMorpherMorphEvaluator::EvaluateAffected(WriteFunc&& Write) const
+{
+	const int32 Count = AffectedVertices.Num();
+	if(Count > 0)
+	{
+		const int32 Cores = Count > FPlatformMisc::NumberOfCoresIncludingHyperthreads() ? FPlatformMisc::NumberOfCoresIncludingHyperthreads() : 1;
+		const int32 ChunkSize = FMath::FloorToInt((static_cast<double>(Count) / static_cast<double>(Cores)));
+		const int32 LastChunkSize = Count - (ChunkSize * Cores);
+		const int32 Chunks = LastChunkSize > 0 ? Cores + 1 : Cores;
+
+		ParallelFor(Chunks, [&](const int32 ChunkIndex)
+		{
+			const int32 IterationSize = ((LastChunkSize > 0) && (ChunkIndex == Chunks - 1)) ? LastChunkSize : ChunkSize;
+			for (int X = 0; X < IterationSize; ++X)
+			{
+				const int32 Index = (ChunkIndex * ChunkSize) + X;
+				const int32 VertexID = AffectedVertices[Index];
+
+				FVector3d Position = BasePositions[VertexID];
+				for (int32 Slot = RowOffsets[Index]; Slot < RowOffsets[Index + 1]; ++Slot)
+				{
+					const float Weight = Weights[RowMorphIndices[Slot]];
+					if (Weight != 0.0f)
+					{
+						Position += FVector3d(RowDeltas[Slot] * Weight);
+					}
+				}
+				Write(VertexID, Position);
+			}
+		});
+	}
+}
+
+void FMeshMorpherMorphEvaluator::Evaluate(TArray<FVector3f>& OutPositions) const
+{
+	if (OutPositions.Num() != BasePositions.Num())
+	{
+		OutPositions.SetNumUninitialized(BasePositions.Num());
+	}
+
+	ParallelFor(BasePositions.Num(), [&](const int32 VertexID)
+	{
+		OutPositions[VertexID] = FVector3f(BasePositions[VertexID]);
+	});
+
+	EvaluateAffected([&OutPositions](const int32 VertexID, const FVector3d& Position)
+	{
+		OutPositions[VertexID] = FVector3f(Position);
+	});
+}
+
+void FMeshMorpherMorphEvaluator::Evaluate(FDynamicMesh3& Mesh) const
+{
+	EvaluateAffected([&Mesh](const int32 VertexID, const FVector3d& Position)
+	{
+		if (Mesh.IsVertex(VertexID))
+		{
+			Mesh.SetVertex(VertexID, Position, false);
+		}
+	});
+}
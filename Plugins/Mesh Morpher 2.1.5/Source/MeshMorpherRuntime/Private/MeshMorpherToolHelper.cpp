@@ -3,9 +3,11 @@
 #include "FrameTypes.h"
 #include "Components/MeshMorpherMeshComponent.h"
 #include "Misc/FileHelper.h"
+#include "HAL/FileManager.h"
 #include "Misc/FeedbackContext.h"
 #include "Generators/SphereGenerator.h"
 #include "MeshOperationsLibraryRT.h"
+#include "Async/ParallelFor.h"
 
 #define LOCTEXT_NAMESPACE "MeshMorpherToolHelper"
 
@@ -149,15 +151,151 @@ bool UMeshMorpherToolHelper::BrushPositionEqualsBrushPosition(const FBrushPositi
 	return A.Location.Equals(B.Location) && A.Normal.Equals(B.Normal);
 }
 
-void UMeshMorpherToolHelper::ExportMeshComponentToOBJFile(UMeshMorpherMeshComponent* MeshComponent, const TSet<int32>& SelectedTriangles, FString FilePath, bool bInvert, const TArray<FSkeletalMaterial>& Materials)
+//Fixed size ANSI buffer used by the OBJ exporter, flushed to the archive whenever it runs out of space.
+class FMeshMorpherOBJWriter
+{
+public:
+	explicit FMeshMorpherOBJWriter(FArchive* InArchive)
+		: Archive(InArchive)
+	{
+		Buffer.SetNumUninitialized(BufferSize);
+	}
+
+	~FMeshMorpherOBJWriter()
+	{
+		Flush();
+	}
+
+	void Flush()
+	{
+		if (Length > 0)
+		{
+			Archive->Serialize(Buffer.GetData(), Length);
+			Length = 0;
+		}
+	}
+
+	void Write(const ANSICHAR* Data, const int32 Count)
+	{
+		if (Length + Count > BufferSize)
+		{
+			Flush();
+			if (Count > BufferSize)
+			{
+				Archive->Serialize(const_cast<ANSICHAR*>(Data), Count);
+				return;
+			}
+		}
+		FMemory::Memcpy(Buffer.GetData() + Length, Data, Count);
+		Length += Count;
+	}
+
+	void Write(const ANSICHAR* Data)
+	{
+		Write(Data, FCStringAnsi::Strlen(Data));
+	}
+
+	void Write(const ANSICHAR Char)
+	{
+		if (Length + 1 > BufferSize)
+		{
+			Flush();
+		}
+		Buffer[Length++] = Char;
+	}
+
+	void WriteInt(const int64 Value)
+	{
+		ANSICHAR Digits[24];
+		int32 Count = 0;
+		uint64 Remaining = Value < 0 ? static_cast<uint64>(-Value) : static_cast<uint64>(Value);
+		do
+		{
+			Digits[Count++] = static_cast<ANSICHAR>('0' + (Remaining % 10));
+			Remaining /= 10;
+		}
+		while (Remaining > 0);
+
+		if (Value < 0)
+		{
+			Write('-');
+		}
+		while (Count > 0)
+		{
+			Write(Digits[--Count]);
+		}
+	}
+
+	//Fixed six decimals, same output as %lf for the coordinate range we export
+	void WriteDouble(double Value)
+	{
+		if (!FMath::IsFinite(Value))
+		{
+			Value = 0.0;
+		}
+
+		if (FMath::Abs(Value) >= 1.0e9)
+		{
+			Write(TCHAR_TO_ANSI(*FString::Printf(TEXT("%lf"), Value)));
+			return;
+		}
+
+		if (Value < 0.0)
+		{
+			Write('-');
+			Value = -Value;
+		}
+
+		const uint64 Scaled = static_cast<uint64>(Value * 1000000.0 + 0.5);
+		WriteInt(static_cast<int64>(Scaled / 1000000));
+		Write('.');
+
+		uint64 Fraction = Scaled % 1000000;
+		ANSICHAR Digits[6];
+		for (int32 Digit = 5; Digit >= 0; --Digit)
+		{
+			Digits[Digit] = static_cast<ANSICHAR>('0' + (Fraction % 10));
+			Fraction /= 10;
+		}
+		Write(Digits, 6);
+	}
+
+	void WriteFaceCorner(const int32 Index, const bool bUV, const bool bNormal)
+	{
+		Write(' ');
+		WriteInt(Index);
+		if (bUV || bNormal)
+		{
+			Write('/');
+			if (bUV)
+			{
+				WriteInt(Index);
+			}
+			if (bNormal)
+			{
+				Write('/');
+				WriteInt(Index);
+			}
+		}
+	}
+
+private:
+	static constexpr int32 BufferSize = 1024 * 1024;
+
+	FArchive* Archive = nullptr;
+	TArray<ANSICHAR> Buffer;
+	int32 Length = 0;
+};
+
+void UMeshMorpherToolHelper::ExportMeshComponentToOBJFile(UMeshMorpherMeshComponent* MeshComponent, const TSet<int32>& SelectedTriangles, FString FilePath, bool bInvert, const TArray<FSkeletalMaterial>& Materials, bool bExportNormals, bool bExportUVs)
 {
 	if (MeshComponent)
 	{
-		ExportMeshToOBJFile(MeshComponent->GetMesh(), SelectedTriangles, FilePath, bInvert, Materials);
+		ExportMeshToOBJFile(MeshComponent->GetMesh(), SelectedTriangles, FilePath, bInvert, Materials, bExportNormals, bExportUVs);
 	}
 }
 
-void UMeshMorpherToolHelper::ExportMeshToOBJFile(FDynamicMesh3* Mesh, const TSet<int32>& SelectedTriangles, FString FilePath, bool bInvert, const TArray<FSkeletalMaterial>& Materials)
+void UMeshMorpherToolHelper::ExportMeshToOBJFile(FDynamicMesh3* Mesh, const TSet<int32>& SelectedTriangles, FString FilePath, bool bInvert, const TArray<FSkeletalMaterial>& Materials, bool bExportNormals, bool bExportUVs)
 {
 	if (Mesh)
 	{
@@ -182,10 +320,16 @@ void UMeshMorpherToolHelper::ExportMeshToOBJFile(FDynamicMesh3* Mesh, const TSet
 			FDynamicMeshNormalOverlay* NormalOverlay = nullptr;
 			if (bHasAttributes)
 			{
-				UVOverlay = Mesh->Attributes()->PrimaryUV();
+				UVOverlay = bExportUVs ? Mesh->Attributes()->PrimaryUV() : nullptr;
 				NormalOverlay = Mesh->Attributes()->PrimaryNormals();
 			}
 
+			TUniquePtr<FArchive> FileWriter(IFileManager::Get().CreateFileWriter(*FilePath));
+			if (!FileWriter)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Could not open %s for writing."), *FilePath);
+				return;
+			}
 
 			FFormatNamedArguments Args;
 			Args.Add(TEXT("OBJFilename"), FText::FromString(FilePath));
@@ -196,206 +340,678 @@ void UMeshMorpherToolHelper::ExportMeshToOBJFile(FDynamicMesh3* Mesh, const TSet
 				GWarn->GetScopeStack().Last()->MakeDialog(false, true);
 			}
 
-			TArray<FString> FileString;
 			FText OBJUpdate;
 
-			OBJUpdate = FText::FromString("Writing header data...");
+			OBJUpdate = FText::FromString("Preparing Triangle data...");
 			GWarn->StatusForceUpdate(0, 4, OBJUpdate);
-			const FString FirstLine = "# Mesh Morpher OBJ exporter.";
-			FileString.Add(FirstLine);
-			FileString.Add(FString("# X Forward Y UP"));
-
 
-			TArray<FString> StringVertices;
-			TArray<FString> StringNormals;
-			TArray<FString> StringUVs;
-			TMap<int32, int32> VerticeMap;
-			TMap<int32, TArray<FString>> TriangleMapping;
+			TArray<int32> ExportTriangles;
+			if (SelectedTriangles.Num() <= 0)
+			{
+				ExportTriangles.Reserve(Mesh->TriangleCount());
+				for (const int32 Tri : Mesh->TriangleIndicesItr())
+				{
+					ExportTriangles.Add(Tri);
+				}
+			}
+			else if (!bInvert)
+			{
+				ExportTriangles = SelectedTriangles.Array();
+				ExportTriangles.Sort();
+			}
+			else
+			{
+				ExportTriangles.Reserve(FMath::Max(Mesh->TriangleCount() - SelectedTriangles.Num(), 0));
+				for (const int32 Tri : Mesh->TriangleIndicesItr())
+				{
+					if (!SelectedTriangles.Contains(Tri))
+					{
+						ExportTriangles.Add(Tri);
+					}
+				}
+			}
 
-			OBJUpdate = FText::FromString("Preparing Triangle data...");
-			GWarn->StatusForceUpdate(1, 4, OBJUpdate);
+			//Exported vertices: mesh vertex, normal element, uv element
+			TArray<FIndex3i> ExportVertices;
+			TArray<int32> VertexMap;
+			VertexMap.Init(INDEX_NONE, Mesh->MaxVertexID());
+			TMap<int32, TArray<FIndex3i>> TriangleMapping;
 
+			//A full export of a compact mesh writes every vertex in vertex ID order so the IDs survive an import,
+			//anything else writes the used vertices in first-use order
+			const bool bKeepVertexIDs = SelectedTriangles.Num() <= 0 && Mesh->IsCompactV();
+			if (bKeepVertexIDs)
+			{
+				ExportVertices.SetNumUninitialized(Mesh->MaxVertexID());
+				for (int32 VertexID = 0; VertexID < Mesh->MaxVertexID(); ++VertexID)
+				{
+					ExportVertices[VertexID] = FIndex3i(VertexID, FDynamicMesh3::InvalidID, FDynamicMesh3::InvalidID);
+					VertexMap[VertexID] = VertexID;
+				}
+			}
 
-			auto AddVertex = [&](const uint32& VertIdx, const uint32& NormalIdx, const uint32& UVIdx)->int32
+			for (const int32 Tri : ExportTriangles)
 			{
-				if (!VerticeMap.Contains(VertIdx))
+				int32 TriangleGroup = 0;
+				if (bHasMaterial && MaterialID)
 				{
-					FVector Normal = (NormalOverlay != nullptr && NormalIdx != FDynamicMesh3::InvalidID) ? FVector(NormalOverlay->GetElement(NormalIdx)) : FMeshNormals::ComputeVertexNormal(*Mesh, VertIdx);
+					MaterialID->GetValue(Tri, &TriangleGroup);
+				}
 
-					const FVector Vertex = Mesh->GetVertex(VertIdx);
-					const int32 NewVertexID = StringVertices.Add(FString::Printf(TEXT("v %lf %lf %lf"), Vertex.X, Vertex.Z, Vertex.Y));
-					StringNormals.Add(FString::Printf(TEXT("vn %lf %lf %lf"), Normal.X, Normal.Z, Normal.Y));
-					if ((UVOverlay != nullptr && UVIdx != FDynamicMesh3::InvalidID))
+				const FIndex3i Indices = Mesh->GetTriangle(Tri);
+				const FIndex3i TriUV = (UVOverlay != nullptr) ? UVOverlay->GetTriangle(Tri) : FIndex3i(FDynamicMesh3::InvalidID, FDynamicMesh3::InvalidID, FDynamicMesh3::InvalidID);
+				const FIndex3i TriNormal = (NormalOverlay != nullptr) ? NormalOverlay->GetTriangle(Tri) : FIndex3i(FDynamicMesh3::InvalidID, FDynamicMesh3::InvalidID, FDynamicMesh3::InvalidID);
+
+				FIndex3i NewIndices;
+				for (int32 Corner = 0; Corner < 3; ++Corner)
+				{
+					int32& NewVertexID = VertexMap[Indices[Corner]];
+					if (NewVertexID == INDEX_NONE)
 					{
-						FVector2f UV = UVOverlay->GetElement(UVIdx);
-						StringUVs.Add(FString::Printf(TEXT("vt %lf %lf"), UV.X, 1.0 - UV.Y));
+						NewVertexID = ExportVertices.Add(FIndex3i(Indices[Corner], TriNormal[Corner], TriUV[Corner]));
+					}
+					else
+					{
+						//first triangle with an element wins
+						FIndex3i& ExportVertex = ExportVertices[NewVertexID];
+						if (ExportVertex.B == FDynamicMesh3::InvalidID)
+						{
+							ExportVertex.B = TriNormal[Corner];
+						}
+						if (ExportVertex.C == FDynamicMesh3::InvalidID)
+						{
+							ExportVertex.C = TriUV[Corner];
+						}
 					}
-					VerticeMap.Add(VertIdx, NewVertexID);
-					return NewVertexID;
+					NewIndices[Corner] = NewVertexID;
 				}
-				else {
 
-					return VerticeMap[VertIdx];
+				TriangleMapping.FindOrAdd(TriangleGroup).Add(NewIndices);
+			}
+
+			OBJUpdate = FText::FromString("Sorting Triangle data...");
+			GWarn->StatusForceUpdate(1, 4, OBJUpdate);
+			TriangleMapping.KeySort([](const int32& A, const int32& B)
+				{
+					return A < B;
+				});
+
+			FMeshMorpherOBJWriter Writer(FileWriter.Get());
+
+			OBJUpdate = FText::FromString("Writing Vertex data...");
+			GWarn->StatusForceUpdate(2, 4, OBJUpdate);
+			Writer.Write("# Mesh Morpher OBJ exporter.\n");
+			Writer.Write("# X Forward Y UP\n");
+
+			for (const FIndex3i& ExportVertex : ExportVertices)
+			{
+				const FVector3d Vertex = Mesh->GetVertex(ExportVertex.A);
+				Writer.Write("v ");
+				Writer.WriteDouble(Vertex.X);
+				Writer.Write(' ');
+				Writer.WriteDouble(Vertex.Z);
+				Writer.Write(' ');
+				Writer.WriteDouble(Vertex.Y);
+				Writer.Write('\n');
+			}
+
+			if (bExportNormals)
+			{
+				for (const FIndex3i& ExportVertex : ExportVertices)
+				{
+					const FVector3d Normal = (NormalOverlay != nullptr && ExportVertex.B != FDynamicMesh3::InvalidID) ? FVector3d(NormalOverlay->GetElement(ExportVertex.B)) : FMeshNormals::ComputeVertexNormal(*Mesh, ExportVertex.A);
+					Writer.Write("vn ");
+					Writer.WriteDouble(Normal.X);
+					Writer.Write(' ');
+					Writer.WriteDouble(Normal.Z);
+					Writer.Write(' ');
+					Writer.WriteDouble(Normal.Y);
+					Writer.Write('\n');
 				}
-			};
+			}
 
-			auto GetTriGroup = [&](const uint32& TriIdx)->int32
+			//One vt per exported vertex so face indices stay shared, even where the overlay has no element
+			if (UVOverlay != nullptr)
 			{
-				int32 TriangleGroup = 0;
-				if (bHasMaterial && MaterialID)
+				for (const FIndex3i& ExportVertex : ExportVertices)
 				{
-					MaterialID->GetValue(TriIdx, &TriangleGroup);
+					const FVector2f UV = (ExportVertex.C != FDynamicMesh3::InvalidID) ? UVOverlay->GetElement(ExportVertex.C) : FVector2f::ZeroVector;
+					Writer.Write("vt ");
+					Writer.WriteDouble(UV.X);
+					Writer.Write(' ');
+					Writer.WriteDouble(1.0 - UV.Y);
+					Writer.Write('\n');
 				}
-				return TriangleGroup;
-			};
+			}
+
+			OBJUpdate = FText::FromString("Writing Triangle data...");
+			GWarn->StatusForceUpdate(3, 4, OBJUpdate);
 
 			// "f v1//vn1 v2//vn2 v3//vn3"
 			// "f v1/vt1 v2/vt2 v3/vt3"
 			// "f v1/vt1/vn1 v2/vt2/vn2 v3/vt3/vn3"
-
-			if (SelectedTriangles.Num() <= 0)
+			const bool bWriteUVs = UVOverlay != nullptr;
+			for (const TPair<int32, TArray<FIndex3i>>& TriObj : TriangleMapping)
 			{
-				for (const int32& Tri : Mesh->TriangleIndicesItr())
+				Writer.Write("o ");
+				if(Materials.IsValidIndex(TriObj.Key) && !Materials[TriObj.Key].MaterialSlotName.IsNone())
+				{
+					const FTCHARToUTF8 SlotName(*Materials[TriObj.Key].MaterialSlotName.ToString());
+					Writer.Write(SlotName.Get(), SlotName.Length());
+				} else
+				{
+					Writer.WriteInt(TriObj.Key);
+				}
+				Writer.Write('\n');
+
+				for (const FIndex3i& Triangle : TriObj.Value)
 				{
-					int32 TriangleGroup = GetTriGroup(Tri);
+					Writer.Write('f');
+					Writer.WriteFaceCorner(Triangle.A + 1, bWriteUVs, bExportNormals);
+					Writer.WriteFaceCorner(Triangle.B + 1, bWriteUVs, bExportNormals);
+					Writer.WriteFaceCorner(Triangle.C + 1, bWriteUVs, bExportNormals);
+					Writer.Write('\n');
+				}
+			}
 
-					const FIndex3i Indices = Mesh->GetTriangle(Tri);
-					FIndex3i NewIndices;
+			OBJUpdate = FText::FromString("Writing File...");
+			GWarn->StatusForceUpdate(4, 4, OBJUpdate);
+			Writer.Flush();
+			FileWriter->Close();
 
-					const FIndex3i TriUV = (UVOverlay != nullptr) ? UVOverlay->GetTriangle(Tri) : FIndex3i(FDynamicMesh3::InvalidID, FDynamicMesh3::InvalidID, FDynamicMesh3::InvalidID);
-					const FIndex3i TriNormal = (NormalOverlay != nullptr) ? NormalOverlay->GetTriangle(Tri) : FIndex3i(FDynamicMesh3::InvalidID, FDynamicMesh3::InvalidID, FDynamicMesh3::InvalidID);
+			GWarn->EndSlowTask();
+			
+		}
 
-					for (int32 Corner = 0; Corner < 3; ++Corner)
-					{
-						NewIndices[Corner] = AddVertex((uint32)Indices[Corner], TriNormal[Corner], TriUV[Corner]);
-					}
+	}
+}
+
+enum class EMeshMorpherOBJLine : uint8
+{
+	Other,
+	Position,
+	UV,
+	Normal,
+	Face,
+	Group,
+};
+
+static const ANSICHAR* SkipOBJSpaces(const ANSICHAR* Cursor, const ANSICHAR* End)
+{
+	while (Cursor < End && (*Cursor == ' ' || *Cursor == '\t' || *Cursor == '\r'))
+	{
+		++Cursor;
+	}
+	return Cursor;
+}
+
+static const ANSICHAR* SkipOBJLine(const ANSICHAR* Cursor, const ANSICHAR* End)
+{
+	while (Cursor < End && *Cursor != '\n')
+	{
+		++Cursor;
+	}
+	return Cursor < End ? Cursor + 1 : End;
+}
+
+static bool IsOBJSpace(const ANSICHAR Char)
+{
+	return Char == ' ' || Char == '\t';
+}
+
+//Classify the line starting at Cursor and move Cursor past its keyword
+static EMeshMorpherOBJLine ParseOBJKeyword(const ANSICHAR*& Cursor, const ANSICHAR* End)
+{
+	Cursor = SkipOBJSpaces(Cursor, End);
+	const int32 Remaining = End - Cursor;
+	if (Remaining >= 2 && Cursor[0] == 'v')
+	{
+		if (IsOBJSpace(Cursor[1]))
+		{
+			Cursor += 2;
+			return EMeshMorpherOBJLine::Position;
+		}
+		if (Remaining >= 3 && IsOBJSpace(Cursor[2]))
+		{
+			if (Cursor[1] == 't')
+			{
+				Cursor += 3;
+				return EMeshMorpherOBJLine::UV;
+			}
+			if (Cursor[1] == 'n')
+			{
+				Cursor += 3;
+				return EMeshMorpherOBJLine::Normal;
+			}
+		}
+	}
+	else if (Remaining >= 2 && Cursor[0] == 'f' && IsOBJSpace(Cursor[1]))
+	{
+		Cursor += 2;
+		return EMeshMorpherOBJLine::Face;
+	}
+	else if (Remaining >= 2 && (Cursor[0] == 'o' || Cursor[0] == 'g') && IsOBJSpace(Cursor[1]))
+	{
+		Cursor += 2;
+		return EMeshMorpherOBJLine::Group;
+	}
+	else if (Remaining >= 7 && FCStringAnsi::Strncmp(Cursor, "usemtl", 6) == 0 && IsOBJSpace(Cursor[6]))
+	{
+		Cursor += 7;
+		return EMeshMorpherOBJLine::Group;
+	}
+	return EMeshMorpherOBJLine::Other;
+}
+
+static bool ParseOBJInt(const ANSICHAR*& Cursor, const ANSICHAR* End, int32& Out)
+{
+	bool bNegative = false;
+	if (Cursor < End && (*Cursor == '-' || *Cursor == '+'))
+	{
+		bNegative = *Cursor == '-';
+		++Cursor;
+	}
 
-					TArray<FString>& TriangleList = TriangleMapping.FindOrAdd(TriangleGroup);
+	const ANSICHAR* Start = Cursor;
+	int64 Value = 0;
+	while (Cursor < End && *Cursor >= '0' && *Cursor <= '9')
+	{
+		Value = Value * 10 + (*Cursor - '0');
+		++Cursor;
+	}
+	Out = static_cast<int32>(bNegative ? -Value : Value);
+	return Cursor != Start;
+}
+
+static bool ParseOBJDouble(const ANSICHAR*& Cursor, const ANSICHAR* End, double& Out)
+{
+	Cursor = SkipOBJSpaces(Cursor, End);
+
+	bool bNegative = false;
+	if (Cursor < End && (*Cursor == '-' || *Cursor == '+'))
+	{
+		bNegative = *Cursor == '-';
+		++Cursor;
+	}
+
+	const ANSICHAR* Start = Cursor;
+	double Value = 0.0;
+	while (Cursor < End && *Cursor >= '0' && *Cursor <= '9')
+	{
+		Value = Value * 10.0 + (*Cursor - '0');
+		++Cursor;
+	}
+
+	if (Cursor < End && *Cursor == '.')
+	{
+		++Cursor;
+		double Scale = 0.1;
+		while (Cursor < End && *Cursor >= '0' && *Cursor <= '9')
+		{
+			Value += (*Cursor - '0') * Scale;
+			Scale *= 0.1;
+			++Cursor;
+		}
+	}
+
+	if (Cursor == Start)
+	{
+		Out = 0.0;
+		return false;
+	}
 
-					int32 IDx0 = NewIndices.A + 1;
-					int32 IDx1 = NewIndices.B + 1;
-					int32 IDx2 = NewIndices.C + 1;
+	if (Cursor < End && (*Cursor == 'e' || *Cursor == 'E'))
+	{
+		++Cursor;
+		int32 Exponent = 0;
+		if (ParseOBJInt(Cursor, End, Exponent))
+		{
+			Value *= FMath::Pow(10.0, static_cast<double>(Exponent));
+		}
+	}
+
+	Out = bNegative ? -Value : Value;
+	return true;
+}
+
+//Parse "v", "v/vt", "v//vn" or "v/vt/vn". Missing indices are returned as 0.
+static bool ParseOBJFaceCorner(const ANSICHAR*& Cursor, const ANSICHAR* End, FIndex3i& Out)
+{
+	Out = FIndex3i::Zero();
+	Cursor = SkipOBJSpaces(Cursor, End);
+	if (!ParseOBJInt(Cursor, End, Out.A))
+	{
+		return false;
+	}
+
+	if (Cursor < End && *Cursor == '/')
+	{
+		++Cursor;
+		ParseOBJInt(Cursor, End, Out.B);
+		if (Cursor < End && *Cursor == '/')
+		{
+			++Cursor;
+			ParseOBJInt(Cursor, End, Out.C);
+		}
+	}
+
+	//Skip anything we do not understand up to the next separator
+	while (Cursor < End && !IsOBJSpace(*Cursor) && *Cursor != '\r' && *Cursor != '\n')
+	{
+		++Cursor;
+	}
+	return true;
+}
+
+//1-based or negative (relative) OBJ index to 0-based, INDEX_NONE if missing
+static int32 ResolveOBJIndex(const int32 Index, const int32 Count)
+{
+	if (Index > 0)
+	{
+		return Index - 1;
+	}
+	if (Index < 0)
+	{
+		return Count + Index;
+	}
+	return INDEX_NONE;
+}
+
+bool UMeshMorpherToolHelper::ImportOBJFileToDynamicMesh(const FString& FilePath, FDynamicMesh3& OutMesh)
+{
+	TArray<uint8> FileData;
+	if (!FFileHelper::LoadFileToArray(FileData, *FilePath))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Could not read %s."), *FilePath);
+		return false;
+	}
+
+	const ANSICHAR* FileBegin = reinterpret_cast<const ANSICHAR*>(FileData.GetData());
+	const ANSICHAR* FileEnd = FileBegin + FileData.Num();
+
+	struct FOBJChunk
+	{
+		const ANSICHAR* Begin = nullptr;
+		const ANSICHAR* End = nullptr;
+		int32 NumPositions = 0;
+		int32 NumUVs = 0;
+		int32 NumNormals = 0;
+		int32 NumTriangles = 0;
+		int32 NumGroups = 0;
+		int32 FirstPosition = 0;
+		int32 FirstUV = 0;
+		int32 FirstNormal = 0;
+		int32 FirstTriangle = 0;
+		int32 FirstGroup = 0;
+	};
+
+	//Split the file on line boundaries, one chunk per core
+	const int32 Cores = FileData.Num() > FPlatformMisc::NumberOfCoresIncludingHyperthreads() * 4096 ? FPlatformMisc::NumberOfCoresIncludingHyperthreads() : 1;
+	TArray<FOBJChunk> Chunks;
+	{
+		const ANSICHAR* ChunkBegin = FileBegin;
+		for (int32 ChunkIndex = 0; ChunkIndex < Cores && ChunkBegin < FileEnd; ++ChunkIndex)
+		{
+			const ANSICHAR* ChunkEnd = (ChunkIndex == Cores - 1) ? FileEnd : SkipOBJLine(FMath::Max(ChunkBegin, FileBegin + (FileData.Num() / Cores) * (ChunkIndex + 1)), FileEnd);
+			FOBJChunk& Chunk = Chunks.AddDefaulted_GetRef();
+			Chunk.Begin = ChunkBegin;
+			Chunk.End = ChunkEnd;
+			ChunkBegin = ChunkEnd;
+		}
+	}
 
-					if (UVOverlay != nullptr)
+	//First pass, count elements so every chunk knows where to write
+	ParallelFor(Chunks.Num(), [&](const int32 ChunkIndex)
+	{
+		FOBJChunk& Chunk = Chunks[ChunkIndex];
+		const ANSICHAR* Cursor = Chunk.Begin;
+		while (Cursor < Chunk.End)
+		{
+			switch (ParseOBJKeyword(Cursor, Chunk.End))
+			{
+			case EMeshMorpherOBJLine::Position:
+				Chunk.NumPositions++;
+				break;
+			case EMeshMorpherOBJLine::UV:
+				Chunk.NumUVs++;
+				break;
+			case EMeshMorpherOBJLine::Normal:
+				Chunk.NumNormals++;
+				break;
+			case EMeshMorpherOBJLine::Group:
+				Chunk.NumGroups++;
+				break;
+			case EMeshMorpherOBJLine::Face:
+				{
+					int32 Corners = 0;
+					FIndex3i Corner;
+					while (ParseOBJFaceCorner(Cursor, Chunk.End, Corner))
 					{
-						TriangleList.Add(FString::Printf(TEXT("f %d/%d/%d %d/%d/%d %d/%d/%d"), IDx0, IDx0, IDx0, IDx1, IDx1, IDx1, IDx2, IDx2, IDx2));
-					}
-					else {
-						TriangleList.Add(FString::Printf(TEXT("f %d//%d %d//%d %d//%d"), IDx0, IDx0, IDx1, IDx1, IDx2, IDx2));
+						Corners++;
 					}
+					Chunk.NumTriangles += FMath::Max(Corners - 2, 0);
 				}
+				break;
+			default:
+				break;
 			}
-			else {
+			Cursor = SkipOBJLine(Cursor, Chunk.End);
+		}
+	});
+
+	int32 NumPositions = 0;
+	int32 NumUVs = 0;
+	int32 NumNormals = 0;
+	int32 NumTriangles = 0;
+	int32 NumGroups = 0;
+	for (FOBJChunk& Chunk : Chunks)
+	{
+		Chunk.FirstPosition = NumPositions;
+		Chunk.FirstUV = NumUVs;
+		Chunk.FirstNormal = NumNormals;
+		Chunk.FirstTriangle = NumTriangles;
+		Chunk.FirstGroup = NumGroups;
+		NumPositions += Chunk.NumPositions;
+		NumUVs += Chunk.NumUVs;
+		NumNormals += Chunk.NumNormals;
+		NumTriangles += Chunk.NumTriangles;
+		NumGroups += Chunk.NumGroups;
+	}
 
-				TSet<int32> SelectedTrianglesSorted = SelectedTriangles;
-				SelectedTrianglesSorted.Sort([](const int32& A, const int32& B)
+	TArray<FVector3d> Positions;
+	TArray<FVector2f> UVs;
+	TArray<FVector3f> Normals;
+	TArray<FIndex3i> TriangleVertices;
+	TArray<FIndex3i> TriangleUVs;
+	TArray<FIndex3i> TriangleNormals;
+	TArray<TPair<int32, FString>> Groups;
+	Positions.SetNumUninitialized(NumPositions);
+	UVs.SetNumUninitialized(NumUVs);
+	Normals.SetNumUninitialized(NumNormals);
+	TriangleVertices.SetNumUninitialized(NumTriangles);
+	TriangleUVs.SetNumUninitialized(NumTriangles);
+	TriangleNormals.SetNumUninitialized(NumTriangles);
+	Groups.SetNum(NumGroups);
+
+	//Second pass, parse into the final arrays. Axis swap and V flip mirror ExportMeshToOBJFile.
+	ParallelFor(Chunks.Num(), [&](const int32 ChunkIndex)
+	{
+		const FOBJChunk& Chunk = Chunks[ChunkIndex];
+		int32 PositionIndex = Chunk.FirstPosition;
+		int32 UVIndex = Chunk.FirstUV;
+		int32 NormalIndex = Chunk.FirstNormal;
+		int32 TriangleIndex = Chunk.FirstTriangle;
+		int32 GroupIndex = Chunk.FirstGroup;
+
+		const ANSICHAR* Cursor = Chunk.Begin;
+		while (Cursor < Chunk.End)
+		{
+			switch (ParseOBJKeyword(Cursor, Chunk.End))
+			{
+			case EMeshMorpherOBJLine::Position:
 				{
-					return A < B;
-				});
-				
-				if (!bInvert)
+					double X, Y, Z;
+					ParseOBJDouble(Cursor, Chunk.End, X);
+					ParseOBJDouble(Cursor, Chunk.End, Y);
+					ParseOBJDouble(Cursor, Chunk.End, Z);
+					Positions[PositionIndex++] = FVector3d(X, Z, Y);
+				}
+				break;
+			case EMeshMorpherOBJLine::UV:
+				{
+					double U, V;
+					ParseOBJDouble(Cursor, Chunk.End, U);
+					ParseOBJDouble(Cursor, Chunk.End, V);
+					UVs[UVIndex++] = FVector2f(static_cast<float>(U), static_cast<float>(1.0 - V));
+				}
+				break;
+			case EMeshMorpherOBJLine::Normal:
+				{
+					double X, Y, Z;
+					ParseOBJDouble(Cursor, Chunk.End, X);
+					ParseOBJDouble(Cursor, Chunk.End, Y);
+					ParseOBJDouble(Cursor, Chunk.End, Z);
+					Normals[NormalIndex++] = FVector3f(static_cast<float>(X), static_cast<float>(Z), static_cast<float>(Y));
+				}
+				break;
+			case EMeshMorpherOBJLine::Group:
 				{
-					for (const int32& Tri : SelectedTrianglesSorted)
+					const ANSICHAR* NameBegin = SkipOBJSpaces(Cursor, Chunk.End);
+					const ANSICHAR* NameEnd = NameBegin;
+					while (NameEnd < Chunk.End && *NameEnd != '\r' && *NameEnd != '\n')
 					{
-						int32 TriangleGroup = GetTriGroup(Tri);
-						const FIndex3i Indices = Mesh->GetTriangle(Tri);
-						FIndex3i NewIndices;
-
-						const FIndex3i TriUV = (UVOverlay != nullptr) ? UVOverlay->GetTriangle(Tri) : FIndex3i(FDynamicMesh3::InvalidID, FDynamicMesh3::InvalidID, FDynamicMesh3::InvalidID);
-						const FIndex3i TriNormal = (NormalOverlay != nullptr) ? NormalOverlay->GetTriangle(Tri) : FIndex3i(FDynamicMesh3::InvalidID, FDynamicMesh3::InvalidID, FDynamicMesh3::InvalidID);
-
-						for (int32 Corner = 0; Corner < 3; ++Corner)
+						++NameEnd;
+					}
+					Groups[GroupIndex].Key = TriangleIndex;
+					const FUTF8ToTCHAR Name(NameBegin, NameEnd - NameBegin);
+					Groups[GroupIndex].Value = FString(Name.Length(), Name.Get()).TrimEnd();
+					GroupIndex++;
+				}
+				break;
+			case EMeshMorpherOBJLine::Face:
+				{
+					//Fan triangulation of polygons, indices resolved against the elements read so far
+					FIndex3i First = FIndex3i::Invalid();
+					FIndex3i Previous = FIndex3i::Invalid();
+					FIndex3i Corner;
+					int32 Corners = 0;
+					while (ParseOBJFaceCorner(Cursor, Chunk.End, Corner))
+					{
+						const FIndex3i Resolved(ResolveOBJIndex(Corner.A, PositionIndex), ResolveOBJIndex(Corner.B, UVIndex), ResolveOBJIndex(Corner.C, NormalIndex));
+						if (Corners == 0)
 						{
-							NewIndices[Corner] = AddVertex((uint32)Indices[Corner], TriNormal[Corner], TriUV[Corner]);
+							First = Resolved;
 						}
-
-						TArray<FString>& TriangleList = TriangleMapping.FindOrAdd(TriangleGroup);
-
-						int32 IDx0 = NewIndices.A + 1;
-						int32 IDx1 = NewIndices.B + 1;
-						int32 IDx2 = NewIndices.C + 1;
-
-						if (UVOverlay != nullptr)
+						else if (Corners >= 2)
 						{
-							TriangleList.Add(FString::Printf(TEXT("f %d/%d/%d %d/%d/%d %d/%d/%d"), IDx0, IDx0, IDx0, IDx1, IDx1, IDx1, IDx2, IDx2, IDx2));
-						}
-						else {
-							TriangleList.Add(FString::Printf(TEXT("f %d//%d %d//%d %d//%d"), IDx0, IDx0, IDx1, IDx1, IDx2, IDx2));
+							TriangleVertices[TriangleIndex] = FIndex3i(First.A, Previous.A, Resolved.A);
+							TriangleUVs[TriangleIndex] = FIndex3i(First.B, Previous.B, Resolved.B);
+							TriangleNormals[TriangleIndex] = FIndex3i(First.C, Previous.C, Resolved.C);
+							TriangleIndex++;
 						}
+						Previous = Resolved;
+						Corners++;
 					}
 				}
-				else {
-					for (const int32& Tri : Mesh->TriangleIndicesItr())
-					{
-						if (!SelectedTrianglesSorted.Contains(Tri))
-						{
-							int32 TriangleGroup = GetTriGroup(Tri);
-
-							const FIndex3i Indices = Mesh->GetTriangle(Tri);
-							FIndex3i NewIndices;
+				break;
+			default:
+				break;
+			}
+			Cursor = SkipOBJLine(Cursor, Chunk.End);
+		}
+	});
 
-							const FIndex3i TriUV = (UVOverlay != nullptr) ? UVOverlay->GetTriangle(Tri) : FIndex3i(FDynamicMesh3::InvalidID, FDynamicMesh3::InvalidID, FDynamicMesh3::InvalidID);
-							const FIndex3i TriNormal = (NormalOverlay != nullptr) ? NormalOverlay->GetTriangle(Tri) : FIndex3i(FDynamicMesh3::InvalidID, FDynamicMesh3::InvalidID, FDynamicMesh3::InvalidID);
+	OutMesh.Clear();
+	OutMesh.EnableAttributes();
+	OutMesh.EnableTriangleGroups(0);
+	OutMesh.Attributes()->EnableMaterialID();
 
-							for (int32 Corner = 0; Corner < 3; ++Corner)
-							{
-								NewIndices[Corner] = AddVertex((uint32)Indices[Corner], TriNormal[Corner], TriUV[Corner]);
-							}
+	//Vertex IDs follow the file order
+	for (const FVector3d& Position : Positions)
+	{
+		OutMesh.AppendVertex(Position);
+	}
 
-							TArray<FString>& TriangleList = TriangleMapping.FindOrAdd(TriangleGroup);
+	FDynamicMeshUVOverlay* UVOverlay = OutMesh.Attributes()->PrimaryUV();
+	FDynamicMeshNormalOverlay* NormalOverlay = OutMesh.Attributes()->PrimaryNormals();
+	FDynamicMeshMaterialAttribute* MaterialID = OutMesh.Attributes()->GetMaterialID();
 
-							int32 IDx0 = NewIndices.A + 1;
-							int32 IDx1 = NewIndices.B + 1;
-							int32 IDx2 = NewIndices.C + 1;
+	//Overlay elements are created per (vertex, uv) and (vertex, normal) pair, as overlay elements cannot be shared across vertices
+	TMap<uint64, int32> UVElements;
+	TMap<uint64, int32> NormalElements;
+	auto GetElement = [](TMap<uint64, int32>& Elements, const int32 VertexID, const int32 Index, const TFunctionRef<int32()>& Append)->int32
+	{
+		const uint64 Key = (static_cast<uint64>(VertexID) << 32) | static_cast<uint32>(Index);
+		if (const int32* Element = Elements.Find(Key))
+		{
+			return *Element;
+		}
+		return Elements.Add(Key, Append());
+	};
 
-							if (UVOverlay != nullptr)
-							{
-								TriangleList.Add(FString::Printf(TEXT("f %d/%d/%d %d/%d/%d %d/%d/%d"), IDx0, IDx0, IDx0, IDx1, IDx1, IDx1, IDx2, IDx2, IDx2));
-							}
-							else {
-								TriangleList.Add(FString::Printf(TEXT("f %d//%d %d//%d %d//%d"), IDx0, IDx0, IDx1, IDx1, IDx2, IDx2));
-							}
-						}
-					}
-				}
-			}
+	TMap<FString, int32> GroupMaterials;
+	int32 NextGroup = 0;
+	int32 CurrentMaterial = 0;
+	int32 SkippedTriangles = 0;
 
-			OBJUpdate = FText::FromString("Sorting Triangle data...");
-			GWarn->StatusForceUpdate(2, 4, OBJUpdate);
-			TriangleMapping.KeySort([](const int32& A, const int32& B)
-				{
-					return A < B;
-				});
+	for (int32 TriangleIndex = 0; TriangleIndex < NumTriangles; ++TriangleIndex)
+	{
+		while (NextGroup < Groups.Num() && Groups[NextGroup].Key <= TriangleIndex)
+		{
+			const int32* ExistingMaterial = GroupMaterials.Find(Groups[NextGroup].Value);
+			CurrentMaterial = ExistingMaterial ? *ExistingMaterial : GroupMaterials.Add(Groups[NextGroup].Value, GroupMaterials.Num());
+			NextGroup++;
+		}
 
+		const FIndex3i& Triangle = TriangleVertices[TriangleIndex];
+		if (!Positions.IsValidIndex(Triangle.A) || !Positions.IsValidIndex(Triangle.B) || !Positions.IsValidIndex(Triangle.C))
+		{
+			SkippedTriangles++;
+			continue;
+		}
 
-			FileString.Append(StringVertices);
-			FileString.Append(StringNormals);
-			FileString.Append(StringUVs);
+		const int32 TriangleID = OutMesh.AppendTriangle(Triangle, CurrentMaterial);
+		if (TriangleID < 0)
+		{
+			SkippedTriangles++;
+			continue;
+		}
+		MaterialID->SetValue(TriangleID, &CurrentMaterial);
 
-			OBJUpdate = FText::FromString("Writing Triangle data...");
-			GWarn->StatusForceUpdate(3, 4, OBJUpdate);
-			for (auto& TriObj : TriangleMapping)
+		const FIndex3i& TriangleUV = TriangleUVs[TriangleIndex];
+		if (UVs.IsValidIndex(TriangleUV.A) && UVs.IsValidIndex(TriangleUV.B) && UVs.IsValidIndex(TriangleUV.C))
+		{
+			FIndex3i Elements;
+			for (int32 Corner = 0; Corner < 3; ++Corner)
 			{
-				if(Materials.IsValidIndex(TriObj.Key) && !Materials[TriObj.Key].MaterialSlotName.IsNone())
-				{
-					FileString.Add(FString::Printf(TEXT("o %s"), *Materials[TriObj.Key].MaterialSlotName.ToString()));
-				} else
-				{
-					FileString.Add(FString::Printf(TEXT("o %d"), TriObj.Key));
-				}
-				
-				FileString.Append(TriObj.Value);
+				Elements[Corner] = GetElement(UVElements, Triangle[Corner], TriangleUV[Corner], [&]() { return UVOverlay->AppendElement(UVs[TriangleUV[Corner]]); });
 			}
+			UVOverlay->SetTriangle(TriangleID, Elements);
+		}
 
-			OBJUpdate = FText::FromString("Writing File...");
-			GWarn->StatusForceUpdate(4, 4, OBJUpdate);
-			const bool bWriteResult = FFileHelper::SaveStringArrayToFile(FileString, *FilePath);
-
-			GWarn->EndSlowTask();
-			
+		const FIndex3i& TriangleNormal = TriangleNormals[TriangleIndex];
+		if (Normals.IsValidIndex(TriangleNormal.A) && Normals.IsValidIndex(TriangleNormal.B) && Normals.IsValidIndex(TriangleNormal.C))
+		{
+			FIndex3i Elements;
+			for (int32 Corner = 0; Corner < 3; ++Corner)
+			{
+				Elements[Corner] = GetElement(NormalElements, Triangle[Corner], TriangleNormal[Corner], [&]() { return NormalOverlay->AppendElement(Normals[TriangleNormal[Corner]]); });
+			}
+			NormalOverlay->SetTriangle(TriangleID, Elements);
 		}
+	}
 
+	if (NumNormals == 0)
+	{
+		FMeshNormals::InitializeOverlayToPerVertexNormals(NormalOverlay);
 	}
+
+	if (SkippedTriangles > 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s: skipped %d invalid or non-manifold triangles."), *FilePath, SkippedTriangles);
+	}
+
+	return OutMesh.TriangleCount() > 0;
 }
 
 void UMeshMorpherToolHelper::GetBoundaryVertices(UMeshMorpherMeshComponent* MeshComponent, TSet<int32>& Vertices)
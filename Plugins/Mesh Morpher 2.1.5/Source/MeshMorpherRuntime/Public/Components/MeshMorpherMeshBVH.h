@@ -0,0 +1,96 @@
+// Copyright 2020-2022 SC Pug Life Studio S.R.L. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DynamicMesh/DynamicMesh3.h"
+#include "BoxTypes.h"
+#include "RayTypes.h"
+
+using namespace UE::Geometry;
+
+/**
+ * FMeshMorpherMeshBVH is a triangle bounding volume hierarchy over a FDynamicMesh3 that is kept across vertex edits.
+ * After vertices move, only the leaves holding their triangles and the path to the root are refitted in place.
+ * A full rebuild is only needed when the mesh topology changes, or when refitted boxes have grown past MaxQualityRatio
+ * times the surface area they had when the tree was built.
+ */
+class MESHMORPHERRUNTIME_API FMeshMorpherMeshBVH
+{
+public:
+	/** Refitted to built surface area ratio past which NeedsRebuild() returns true */
+	double MaxQualityRatio = 2.0;
+
+	/** Maximum number of triangles stored in a leaf */
+	int32 LeafTriangleCount = 8;
+
+	/** Build the hierarchy over all triangles of InMesh, the mesh must outlive the hierarchy or be replaced with another Build */
+	void Build(const FDynamicMesh3* InMesh);
+
+	/** Release all nodes */
+	void Reset();
+
+	bool IsValid() const { return Mesh != nullptr && Nodes.Num() > 0; }
+
+	const FDynamicMesh3* GetMesh() const { return Mesh; }
+
+	/** @return true if the mesh topology changed since Build or refits degraded the tree past MaxQualityRatio */
+	bool NeedsRebuild() const;
+
+	/** Refit the boxes of every triangle touching ModifiedVertices, and their ancestors */
+	void Refit(const TArray<int32>& ModifiedVertices);
+
+	/** Refit every box, for when the modified vertices are unknown */
+	void RefitAll();
+
+	/** Rebuild if NeedsRebuild(), otherwise refit around ModifiedVertices or everything if the list is empty */
+	void Update(const TArray<int32>& ModifiedVertices);
+
+	/**
+	 * @return the nearest triangle hit by Ray that passes TriangleFilter, or IndexConstants::InvalidID
+	 */
+	int32 FindNearestHitTriangle(const UE::Geometry::TRay<double>& Ray, double& OutHitDistance, TFunctionRef<bool(int32)> TriangleFilter) const;
+
+	int32 FindNearestHitTriangle(const UE::Geometry::TRay<double>& Ray, double& OutHitDistance) const;
+
+	/**
+	 * @return the triangle nearest to Point within MaxDistance, or IndexConstants::InvalidID
+	 */
+	int32 FindNearestTriangle(const FVector3d& Point, double& OutDistanceSqr, const double MaxDistance = TNumericLimits<double>::Max()) const;
+
+private:
+	struct FNode
+	{
+		FAxisAlignedBox3d Box = FAxisAlignedBox3d::Empty();
+		int32 Parent = INDEX_NONE;
+		/** interior nodes: first child, the second child is Child + 1 */
+		int32 Child = INDEX_NONE;
+		/** leaf nodes: range in Triangles */
+		int32 TriangleStart = 0;
+		int32 TriangleCount = 0;
+
+		bool IsLeaf() const { return TriangleCount > 0; }
+	};
+
+	FAxisAlignedBox3d GetTriangleBox(const int32 TriangleID) const;
+
+	void RefitLeaves(const TArray<int32>& Leaves);
+
+	void RefitInterior(const TBitArray<>& DirtyNodes);
+
+	static double GetSurfaceArea(const FAxisAlignedBox3d& Box);
+
+	static bool IntersectRayBox(const UE::Geometry::TRay<double>& Ray, const FVector3d& InvDirection, const FAxisAlignedBox3d& Box, const double MaxDistance, double& OutDistance);
+
+	const FDynamicMesh3* Mesh = nullptr;
+
+	/** nodes are stored parents first, so a reverse walk visits children before their parent */
+	TArray<FNode> Nodes;
+	TArray<int32> Triangles;
+	/** triangle ID to leaf node index */
+	TArray<int32> TriangleLeaves;
+
+	double BuildSurfaceArea = 0.0;
+	double SurfaceArea = 0.0;
+	uint32 TopologyChangeStamp = 0;
+};
@@ -10,6 +10,7 @@
 #include "MeshConversionOptions.h"
 #include "DynamicMesh/DynamicMeshAABBTree3.h"
 #include "DynamicMesh/MeshNormals.h"
+#include "Components/MeshMorpherMeshBVH.h"
 
 #include "MeshMorpherTransformProxy.h"
 #include "BaseGizmos/GizmoComponents.h"
@@ -25,6 +26,7 @@
 struct FMeshDescription;
 class UStandaloneMaskSelection;
 class FMeshMorpherMeshOctree;
+class FMeshMorpherMorphEvaluator;
 
 /** internal FPrimitiveSceneProxy defined in OctreeDynamicMeshSceneProxy.h */
 class FMeshMorpherMeshSceneProxy;
@@ -44,6 +46,119 @@ public:
 };
 
 
+/** Scratch storage of the brush ROI queries, kept between ticks so the queries do not reallocate */
+struct FMeshMorpherROIBuffers
+{
+	TArray<TArray<int32>> BranchTriangles;
+	TArray<TArray<int32>> ChunkVertices;
+	TArray<TArray<int32>> ChunkTriangles;
+	TArray<int32> VertexStamps;
+	TArray<int32> TriangleStamps;
+	TArray<int32> ElementStamps;
+	TArray<int32> NormalTriangles;
+	TArray<int32> NormalIDs;
+	int32 VertexStamp = 0;
+	int32 TriangleStamp = 0;
+	int32 ElementStamp = 0;
+
+	/** @return a stamp that no vertex currently holds, VertexStamps is grown to MaxVertexID if needed */
+	int32 NextVertexStamp(const int32 MaxVertexID)
+	{
+		return NextStamp(VertexStamps, VertexStamp, MaxVertexID);
+	}
+
+	/** @return a stamp that no triangle currently holds, TriangleStamps is grown to MaxTriangleID if needed */
+	int32 NextTriangleStamp(const int32 MaxTriangleID)
+	{
+		return NextStamp(TriangleStamps, TriangleStamp, MaxTriangleID);
+	}
+
+	/** @return a stamp that no overlay element currently holds, ElementStamps is grown to MaxElementID if needed */
+	int32 NextElementStamp(const int32 MaxElementID)
+	{
+		return NextStamp(ElementStamps, ElementStamp, MaxElementID);
+	}
+
+private:
+	static int32 NextStamp(TArray<int32>& Stamps, int32& Stamp, const int32 MaxID)
+	{
+		if (Stamps.Num() < MaxID)
+		{
+			Stamps.SetNumZeroed(MaxID);
+		}
+
+		if (Stamp == MAX_int32)
+		{
+			FMemory::Memzero(Stamps.GetData(), Stamps.Num() * sizeof(int32));
+			Stamp = 0;
+		}
+		return ++Stamp;
+	}
+};
+
+/** Vertex to vertex map across a symmetry plane, valid until the mesh topology changes */
+struct FMeshMorpherMirrorTable
+{
+	TArray<int32> MirrorVertices;
+	FVector3d PlaneOrigin = FVector3d::Zero();
+	FVector3d PlaneNormal = FVector3d::UnitX();
+	double Tolerance = 0.0;
+	uint32 TopologyChangeStamp = 0;
+	int32 MaxVertexID = 0;
+	bool bBuilt = false;
+};
+
+/**
+ * Original positions of the vertices touched during a brush stroke, stored in flat slots.
+ * A slot index per vertex guards against saving a vertex twice. Final positions are read back from the mesh when the stroke ends,
+ * unless an explicit new position was written to the slot through UpdateSavedVertex.
+ * Vertices, OldPositions and NewPositions are moved into the emitted change, only the slot table allocation is kept between strokes.
+ */
+struct FMeshMorpherStrokeChange
+{
+	TArray<int32> VertexSlots;
+	TArray<int32> Vertices;
+	TArray<FVector3d> OldPositions;
+	TArray<FVector3d> NewPositions;
+	TBitArray<> ExplicitNewPositions;
+	bool bActive = false;
+
+	void Begin(const int32 MaxVertexID)
+	{
+		VertexSlots.Init(INDEX_NONE, MaxVertexID);
+		Vertices.Reset();
+		OldPositions.Reset();
+		NewPositions.Reset();
+		ExplicitNewPositions.Reset();
+		bActive = true;
+	}
+
+	/** @return the slot of VertexID, OldPosition is only kept the first time the vertex is saved */
+	int32 SaveVertex(const int32 VertexID, const FVector3d& OldPosition)
+	{
+		if (VertexID >= VertexSlots.Num())
+		{
+			VertexSlots.Add(INDEX_NONE, VertexID + 1 - VertexSlots.Num());
+		}
+
+		int32& Slot = VertexSlots[VertexID];
+		if (Slot == INDEX_NONE)
+		{
+			Slot = Vertices.Add(VertexID);
+			OldPositions.Add(OldPosition);
+			NewPositions.Add(OldPosition);
+			ExplicitNewPositions.Add(false);
+		}
+		return Slot;
+	}
+
+	void SetNewPosition(const int32 Slot, const FVector3d& NewPosition)
+	{
+		NewPositions[Slot] = NewPosition;
+		ExplicitNewPositions[Slot] = true;
+	}
+};
+
 UENUM(BlueprintType)
 enum class EMaskingBehaviour : uint8
 {
@@ -113,6 +228,28 @@ public:
 	UFUNCTION(BlueprintCallable, Meta = (AutoCreateRefTerm = "VertArray2"), Category = "Mesh Morpher|Mesh Component")
 		void ApplyChanges(const TArray<int32>& VertArray1, const TArray<int32>& VertArray2, const bool bUpdateSpatialData = false);
 
+	/**
+	 * Capture the morph targets of SkeletalMesh at LOD for CPU evaluation, using the current internal mesh as base.
+	 * The internal mesh is expected to share the base vertex order of that LOD. Nothing is captured if its vertex count differs from the
+	 * morph data (render data when the morph data has no base vertex count) or a delta points past its last vertex.
+	 * @return true if at least one morph target was captured
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Mesh Morpher|Mesh Component|Morph Targets")
+		bool InitializeMorphTargets(USkeletalMesh* SkeletalMesh, const int32 LOD = 0);
+
+	/**
+	 * Blend the captured morph targets into the internal mesh. Morph targets missing from Weights are set to zero.
+	 * @return false if no morph targets were captured
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Mesh Morpher|Mesh Component|Morph Targets")
+		bool EvaluateMorphTargets(const TMap<FName, float>& Weights);
+
+	/**
+	 * Blend the captured morph targets into OutPositions (indexed by vertex ID) without touching the internal mesh.
+	 * OutPositions can be reused between calls to avoid reallocation.
+	 */
+	bool EvaluateMorphTargetPositions(const TMap<FName, float>& Weights, TArray<FVector3f>& OutPositions);
+
 	/**
 	 * This delegate fires when a FCommandChange is applied to this component, so that
 	 * parent objects know the mesh has changed.
@@ -198,12 +335,31 @@ public:
 
 	TSharedPtr<FMeshMorpherMeshOctree> Octree;
 
+	TSharedPtr<FMeshMorpherMorphEvaluator> MorphEvaluator;
+
+	/** refitted after every mesh update, serves ray picking */
+	FMeshMorpherMeshBVH MeshBVH;
+
 	FDynamicMesh3 SpatialMesh;
-	UE::Geometry::FDynamicMeshAABBTree3 SpatialData;
+	/**
+	 * Hierarchy over SpatialMesh. This used to be a UE::Geometry::FDynamicMeshAABBTree3, code that used its API directly
+	 * has to move to FMeshMorpherMeshBVH::FindNearestTriangle / FindNearestHitTriangle or FindNearestTriangleOnSpatialMesh.
+	 */
+	FMeshMorpherMeshBVH SpatialData;
 	UE::Geometry::FMeshNormals SpatialNormals;
 
 private:
-	TSharedPtr<FMeshVertexChangeBuilder> ActiveVertexChange = nullptr;
+	FMeshMorpherStrokeChange ActiveStroke;
+	mutable FMeshMorpherROIBuffers ROIBuffers;
+	FMeshMorpherMirrorTable MirrorTable;
+	/** vertices modified since SpatialMesh was last refreshed */
+	TBitArray<> SpatialDirtyVertices;
+	TArray<int32> SpatialDirtyList;
+	uint32 SpatialTopologyChangeStamp = 0;
+	bool bSpatialMeshCopied = false;
+
+	void MarkSpatialDirty(const TArray<int32>& VertArray);
+	void UpdateSpatialData(const bool bFullCopy);
 	FMeshMorpherMeshSceneProxy* CurrentProxy = nullptr;
 
 	//~ Begin UPrimitiveComponent Interface.
@@ -245,6 +401,13 @@ public:
 
 	UFUNCTION(BlueprintPure, Category = "Mesh Morpher|ROI")
 		void GetTriangleROI2(const TSet<int32>& VertexROI, TSet<int32>& TriangleROI) const;
+
+	/**
+	 * Same result as GetTriangleROI, written to a flat array. Duplicates are rejected with a per-triangle stamp buffer instead of a hash set,
+	 * and TriangleROI is only Reset so a caller-owned array keeps its allocation between ticks.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure = false, Category = "Mesh Morpher|ROI")
+		void GetTriangleROIArray(const TArray<int32>& VertexROI, TArray<int32>& TriangleROI) const;
 	
 	UFUNCTION(BlueprintPure, Meta = (AutoCreateRefTerm = "Sections, Bones"), Category = "Mesh Morpher|Mesh Component|Selection")
 		void GetSelectedFromSections(const TArray<int32>& Sections, TSet<int32>& OutSelectedVertices, TSet<int32>& OutSelectedTriangles) const;
@@ -545,6 +708,10 @@ public:
 
 	UFUNCTION(BlueprintCallable, Meta = (AutoCreateRefTerm = "VertArray"), Category = ToolLibrary)
 		void UpdateNormals();
+
+	/** Recompute vertex or overlay normals only around ModifiedVertices, including their one ring */
+	UFUNCTION(BlueprintCallable, Category = "Mesh Morpher|Mesh Component|DynamicMesh")
+		void UpdateRegionNormals(const TArray<int32>& ModifiedVertices);
 	
 	UFUNCTION(BlueprintPure, Category = "Mesh Morpher|Hit Test")
 		int32 FindHitSpatialMeshTriangle(const FVector& RayOrigin, const FVector& RayDirection, const FVector& EyePosition, const bool bHitBackFaces) const;
@@ -564,6 +731,29 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Mesh Morpher|ROI")
 		void ComputeROIBrushPlane(const TArray<int32>& TriangleROI, const FVector& BrushCenter, const double BrushSize, const double FalloffAmount, const double Depth, const bool bIgnoreDepth, FVector& PlaneOrigin, FVector& PlaneNormal) const;
 
+	/**
+	 * Build the mirror table of the current mesh across the plane through PlaneOrigin with PlaneNormal, in local space.
+	 * Vertices with no counterpart within Tolerance map to INDEX_NONE. The table stays valid until the topology changes.
+	 * @return number of vertices that found a counterpart
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Mesh Morpher|Symmetry")
+		int32 BuildMirrorTable(const FVector& PlaneOrigin, const FVector& PlaneNormal, const double Tolerance = 0.01);
+
+	UFUNCTION(BlueprintCallable, Category = "Mesh Morpher|Symmetry")
+		void InvalidateMirrorTable();
+
+	/** @return true if the mirror table was built for the current topology */
+	UFUNCTION(BlueprintPure, Category = "Mesh Morpher|Symmetry")
+		bool HasValidMirrorTable() const;
+
+	/** @return the mirrored vertex of VertexID, or INDEX_NONE if there is none or the table is out of date */
+	UFUNCTION(BlueprintPure, Category = "Mesh Morpher|Symmetry")
+		int32 GetMirrorVertex(const int32 VertexID) const;
+
+	/** Mirror every vertex of VertexIDs, vertices without a counterpart are skipped */
+	UFUNCTION(BlueprintPure, Category = "Mesh Morpher|Symmetry")
+		void GetMirrorVertices(const TArray<int32>& VertexIDs, TArray<int32>& OutMirrorVertices) const;
+
 	UFUNCTION(BlueprintPure, Category = "Mesh Morpher|Brush")
 		bool GetBrushPositionOnMesh(const FVector& RayOrigin, const FVector& RayDirection, const FVector& EyePosition, const bool bHitBackFaces, const bool bNeedsSymmetry, const FVector SymmetryAxis, FBrushPosition& BrushPosition, FBrushPosition& SymmetricBrushPosition) const;
 
@@ -588,6 +778,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Mesh Morpher|Undo")
 		void UpdateSavedVertex(const int32 VertexID, const FVector& OldPosition, const FVector& NewPosition);
 
+	/** Save the current positions of VertexIDs into the active change, call before moving them */
+	UFUNCTION(BlueprintCallable, Category = "Mesh Morpher|Undo")
+		void UpdateSavedVertices(const TArray<int32>& VertexIDs);
+
 	UFUNCTION(BlueprintCallable, Category = "Mesh Morpher|Mesh Component|Transform")
 		FTransform ApplyTransform(const FTransform& NewTransform, bool bInvertMask);
 
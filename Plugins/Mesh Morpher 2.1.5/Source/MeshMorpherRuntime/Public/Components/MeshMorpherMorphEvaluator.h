@@ -0,0 +1,77 @@
+// Copyright 2020-2022 SC Pug Life Studio S.R.L. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DynamicMesh/DynamicMesh3.h"
+#include "Animation/MorphTarget.h"
+
+using namespace UE::Geometry;
+
+/**
+ * FMeshMorpherMorphEvaluator blends morph target deltas on the CPU, without any render resources.
+ * Deltas are stored per vertex (compressed rows of morph index and delta), so evaluation is a single
+ * parallel pass over the vertices that have at least one delta, with no allocations once initialized.
+ */
+class MESHMORPHERRUNTIME_API FMeshMorpherMorphEvaluator
+{
+public:
+	/**
+	 * Capture the base positions of BaseMesh and the deltas of every morph target.
+	 * Delta SourceIdx values are expected to be vertex IDs of BaseMesh.
+	 */
+	void Initialize(const FDynamicMesh3& BaseMesh, const TArray<FName>& InMorphNames, const TArray<TArray<FMorphTargetDelta>>& InMorphDeltas);
+
+	/** Release all cached data */
+	void Reset();
+
+	bool IsInitialized() const { return BasePositions.Num() > 0; }
+
+	int32 NumMorphs() const { return MorphNames.Num(); }
+
+	const TArray<FName>& GetMorphNames() const { return MorphNames; }
+
+	/** @return index of the morph target or INDEX_NONE */
+	int32 FindMorphIndex(const FName& MorphName) const;
+
+	/** Set all weights to zero */
+	void ClearWeights();
+
+	void SetWeight(const int32 MorphIndex, const float Weight);
+
+	/** Set the weights of the named morph targets, leaving the others untouched. Unknown names are ignored. */
+	void SetWeights(const TMap<FName, float>& InWeights);
+
+	/** Vertex IDs that are moved by at least one morph target */
+	const TArray<int32>& GetAffectedVertices() const { return AffectedVertices; }
+
+	/** Triangles that touch at least one affected vertex */
+	const TArray<int32>& GetAffectedTriangles() const { return AffectedTriangles; }
+
+	/**
+	 * Write base positions plus the weighted sum of deltas into OutPositions, indexed by vertex ID.
+	 * OutPositions is resized to the base mesh MaxVertexID on first use only.
+	 */
+	void Evaluate(TArray<FVector3f>& OutPositions) const;
+
+	/** Write blended positions of the affected vertices into Mesh, which must share the base mesh vertex IDs */
+	void Evaluate(FDynamicMesh3& Mesh) const;
+
+private:
+	template<typename WriteFunc>
+	void EvaluateAffected(WriteFunc&& Write) const;
+
+	TArray<FName> MorphNames;
+	TMap<FName, int32> MorphIndices;
+	TArray<float> Weights;
+
+	TArray<FVector3d> BasePositions;
+
+	/** AffectedVertices[i] owns the deltas in [RowOffsets[i], RowOffsets[i + 1]) */
+	TArray<int32> AffectedVertices;
+	TArray<int32> RowOffsets;
+	TArray<int32> RowMorphIndices;
+	TArray<FVector3f> RowDeltas;
+
+	TArray<int32> AffectedTriangles;
+};
@@ -576,6 +576,133 @@ public:
 	}	
 	
 	
+	/**
+	 * Sphere version of ParallelRangeQueryArray. Cells entirely outside the sphere are culled, cells entirely inside it
+	 * are accepted with their whole branch without testing any further cell boxes.
+	 * @param BranchBuffers scratch arrays, one per root cell, kept by the caller so repeated queries do not reallocate
+	 */
+	void ParallelSphereQueryArray(const FVector3d& Center, const double Radius, TArray<int>& ObjectIDs, TArray<TArray<int32>>& BranchBuffers, const bool bOnlyFacingCamera = false, const FVector EyePosition = FVector::ZeroVector, const TSet<int32>& SelectedTriangles = TSet<int32>(), const EMaskingBehaviour MaskVisibility = EMaskingBehaviour::NONE) const
+	{
+		ObjectIDs.Reset();
+		for (int tid : SpillObjectSet)
+		{
+			ObjectIDs.Add(tid);
+		}
+
+		const double RadiusSqr = Radius * Radius;
+		TArray<TPair<const FSparseOctreeCell*, bool>, TInlineAllocator<64>> Queue;
+
+		// start at root cells
+		RootCells.AllocatedIteration([&](const uint32* RootCellID)
+		{
+			const FSparseOctreeCell* RootCell = &Cells[*RootCellID];
+			const int32 Classification = ClassifyCellSphere(*RootCell, Center, RadiusSqr);
+			if (Classification > 0)
+			{
+				Queue.Add(TPair<const FSparseOctreeCell*, bool>(RootCell, Classification == 2));
+			}
+		});
+
+		if (BranchBuffers.Num() < Queue.Num())
+		{
+			BranchBuffers.SetNum(Queue.Num());
+		}
+
+		ParallelFor(Queue.Num(), [&](const int32 qi)
+		{
+			TArray<int32>& LocalObjectIDs = BranchBuffers[qi];
+			LocalObjectIDs.Reset();
+			BranchSphereQueryArray(Queue[qi].Key, Queue[qi].Value, Center, RadiusSqr, bOnlyFacingCamera, EyePosition, SelectedTriangles, MaskVisibility, LocalObjectIDs);
+		});
+
+		for (int32 qi = 0; qi < Queue.Num(); ++qi)
+		{
+			ObjectIDs.Append(BranchBuffers[qi]);
+		}
+	}
+
+	void BranchSphereQueryArray(const FSparseOctreeCell* ParentCell, const bool bParentInside, const FVector3d& Center, const double RadiusSqr, const bool bOnlyFacingCamera, const FVector EyePosition, const TSet<int32>& SelectedTriangles, const EMaskingBehaviour MaskVisibility, TArray<int>& ObjectIDs) const
+	{
+		TArray<TPair<const FSparseOctreeCell*, bool>, TInlineAllocator<32>> Queue;
+		Queue.Add(TPair<const FSparseOctreeCell*, bool>(ParentCell, bParentInside));
+
+		while (Queue.Num() > 0)
+		{
+			const TPair<const FSparseOctreeCell*, bool> Cur = Queue.Pop(false);
+			const FSparseOctreeCell* CurCell = Cur.Key;
+
+			// process elements
+			CellObjectLists.Enumerate(CurCell->CellID, [&](const int32 ObjectID)
+			{
+				if(SelectedTriangles.Contains(ObjectID) && MaskVisibility == EMaskingBehaviour::HIDESELECTED)
+				{
+					return;
+				}
+			
+				if(!SelectedTriangles.Contains(ObjectID) && MaskVisibility == EMaskingBehaviour::HIDEUNSELECTED)
+				{
+					return;
+				}
+				if(Mesh && Mesh->IsTriangle(ObjectID))
+				{
+					if (!bOnlyFacingCamera)
+					{
+						ObjectIDs.Add(ObjectID);
+						return;
+					}
+
+					FVector Normal, Centroid;
+					double Area;
+					Mesh->GetTriInfo(ObjectID, Normal, Area, Centroid);
+					if (FVector::DotProduct(Normal, (Centroid - EyePosition)) < 0.0)
+					{
+						ObjectIDs.Add(ObjectID);
+					}
+				}
+			});
+
+			for (int k = 0; k < 8; ++k)
+			{
+				if (CurCell->HasChild(k))
+				{
+					const FSparseOctreeCell* ChildCell = &Cells[CurCell->GetChildCellID(k)];
+					if (Cur.Value)
+					{
+						Queue.Add(TPair<const FSparseOctreeCell*, bool>(ChildCell, true));
+					}
+					else
+					{
+						const int32 Classification = ClassifyCellSphere(*ChildCell, Center, RadiusSqr);
+						if (Classification > 0)
+						{
+							Queue.Add(TPair<const FSparseOctreeCell*, bool>(ChildCell, Classification == 2));
+						}
+					}
+				}
+			}
+		}
+	}
+
+	/**
+	 * @return 0 if the expanded cell box is outside the sphere, 2 if it is entirely inside, 1 otherwise
+	 */
+	int32 ClassifyCellSphere(const FSparseOctreeCell& Cell, const FVector3d& Center, const double RadiusSqr) const
+	{
+		const FAxisAlignedBox3d CellBox = GetCellBox(Cell, MaxExpandFactor);
+		if (CellBox.DistanceSquared(Center) > RadiusSqr)
+		{
+			return 0;
+		}
+
+		FVector3d FarthestCorner;
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			FarthestCorner[Axis] = FMath::Max(FMath::Abs(Center[Axis] - CellBox.Min[Axis]), FMath::Abs(Center[Axis] - CellBox.Max[Axis]));
+		}
+		return FarthestCorner.SquaredLength() <= RadiusSqr ? 2 : 1;
+	}
+	
+	
 	/**
 	 * Call TriangleFunc for any triangles in the spill set (ie not contained in any Root cell)
 	 */
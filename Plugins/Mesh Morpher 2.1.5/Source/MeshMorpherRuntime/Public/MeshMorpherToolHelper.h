@@ -88,9 +88,21 @@ public:
 		static bool BrushPositionEqualsBrushPosition(const FBrushPosition& A, const FBrushPosition& B);
 
 	UFUNCTION(BlueprintCallable, meta = (AutoCreateRefTerm = "Materials"), Category = "Mesh Morpher|Tools")
-		static void ExportMeshComponentToOBJFile(UMeshMorpherMeshComponent* MeshComponent, const TSet<int32>& SelectedTriangles, FString FilePath, bool bInvert, const TArray<FSkeletalMaterial>& Materials);
-
-	static void ExportMeshToOBJFile(FDynamicMesh3* Mesh, const TSet<int32>& SelectedTriangles, FString FilePath, bool bInvert, const TArray<FSkeletalMaterial>& Materials = TArray<FSkeletalMaterial>());
+		static void ExportMeshComponentToOBJFile(UMeshMorpherMeshComponent* MeshComponent, const TSet<int32>& SelectedTriangles, FString FilePath, bool bInvert, const TArray<FSkeletalMaterial>& Materials, bool bExportNormals = true, bool bExportUVs = true);
+
+	/**
+	 * Stream the mesh (or the selected triangles) to an OBJ file through a fixed size buffer.
+	 * Normals and UVs are optional, faces are grouped per material slot.
+	 * Without a selection, a compact mesh is written with every vertex in vertex ID order, so ImportOBJFileToDynamicMesh gives back the same IDs.
+	 */
+	static void ExportMeshToOBJFile(FDynamicMesh3* Mesh, const TSet<int32>& SelectedTriangles, FString FilePath, bool bInvert, const TArray<FSkeletalMaterial>& Materials = TArray<FSkeletalMaterial>(), bool bExportNormals = true, bool bExportUVs = true);
+
+	/**
+	 * Read an OBJ file into OutMesh. Vertex IDs follow the order of the "v" lines, so a full export of a compact mesh comes back with
+	 * the same vertex IDs, partial exports do not. Polygons are fan triangulated, "o", "g" and "usemtl" start new material IDs.
+	 * @return true if at least one triangle was imported
+	 */
+	static bool ImportOBJFileToDynamicMesh(const FString& FilePath, FDynamicMesh3& OutMesh);
 
 	UFUNCTION(BlueprintPure, Category = "Mesh Morpher|Misc")
 		static void GetBoundaryVertices(UMeshMorpherMeshComponent* MeshComponent, TSet<int32>& Vertices);